@@ -0,0 +1,283 @@
+﻿#include "batch_env.h"
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include "swept_collision.h"
+
+namespace {
+const float INACTIVE_PLAYER_BULLET_Y = -1.0e6f; // Wolny slot: daleko nad ekranem
+const float INACTIVE_ENEMY_BULLET_Y = 1.0e6f;   // Wolny slot: daleko pod ekranem
+const int FORMATION_CELLS = FORMATION_ROWS * FORMATION_COLUMNS;
+
+// Zanim zapełni się ostatni slot, najstarszy pocisk przeleciał cały ekran i zwolnił swój
+static_assert((BatchEnv::PLAYER_BULLET_SLOTS - 1) * ActiveConfig::PLAYER_SHOOT_INTERVAL * ActiveConfig::BULLET_SPEED >=
+                  ActiveConfig::SCREEN_HEIGHT,
+              "Player bullet pool too small for this config");
+static_assert((BatchEnv::ENEMY_BULLET_SLOTS - 1) * ActiveConfig::ENEMY_SHOOT_INTERVAL * ActiveConfig::ENEMY_BULLET_SPEED >=
+                  ActiveConfig::SCREEN_HEIGHT,
+              "Enemy bullet pool too small for this config");
+
+// Zakres komórek siatki (origin + i * spacing, rozmiar size) nachodzących na przedział (lo, hi)
+void cellRange(float lo, float hi, float origin, float size, float spacing, int count, int& first, int& last) {
+    first = std::max(0, static_cast<int>(std::floor((lo - origin - size) / spacing)) + 1);
+    last = std::min(count - 1, static_cast<int>(std::ceil((hi - origin) / spacing)) - 1);
+}
+} // namespace
+
+BatchEnv::BatchEnv(std::size_t games, const GameAssets& assets, std::uint32_t seed)
+    : m_games(games),
+      m_words(cellWords(FORMATION_CELLS)),
+      m_playerSize(assets.playerSize),
+      m_enemySize(assets.enemySize),
+      m_bulletSize(assets.bulletSize),
+      m_enemyBulletSize(assets.enemyBulletSize),
+      m_spacing(static_cast<float>(assets.enemySize.x) * FORMATION_SPACING, static_cast<float>(assets.enemySize.y) * FORMATION_SPACING),
+      m_playerY(SCREEN_HEIGHT - assets.playerSize.y - 10.0f),
+      m_playerMask(&assets.maskFor(TextureId::Player)),
+      m_enemyMask(&assets.maskFor(TextureId::Enemy)),
+      m_bulletMask(&assets.maskFor(TextureId::Bullet)),
+      m_enemyBulletMask(&assets.maskFor(TextureId::EnemyBullet)),
+      m_playerX(games), m_prevPlayerX(games), m_sinceShot(games),
+      m_formationX(games), m_formationY(games), m_direction(games), m_enemyCooldown(games),
+      m_alive(games * m_words), m_aliveCount(games), m_firstColumn(games), m_lastColumn(games), m_lastRow(games), m_rng(games), m_score(games), m_reward(games), m_done(games),
+      m_bulletX(games * PLAYER_BULLET_SLOTS), m_bulletY(games * PLAYER_BULLET_SLOTS),
+      m_enemyBulletX(games * ENEMY_BULLET_SLOTS), m_enemyBulletY(games * ENEMY_BULLET_SLOTS)
+{
+    for (std::size_t g = 0; g < games; ++g) {
+        m_rng[g] = deriveSeed(seed, g) | 1u; // xorshift32 nie może mieć stanu 0
+        resetGameAt(g);
+    }
+}
+
+void BatchEnv::resetGameAt(std::size_t g) {
+    m_score[g] = 0;
+    m_sinceShot[g] = 0.f;
+    resetWaveAt(g);
+}
+
+void BatchEnv::resetWaveAt(std::size_t g) {
+    const sf::Vector2f start(formationStart(Vec2(m_enemySize)));
+    m_playerX[g] = SCREEN_WIDTH / 2.0f - m_playerSize.x / 2.0f;
+    m_prevPlayerX[g] = m_playerX[g];
+    m_formationX[g] = start.x;
+    m_formationY[g] = start.y;
+    m_direction[g] = 1.0f;
+    m_enemyCooldown[g] = 0.f;
+    fillCells(&m_alive[g * m_words], FORMATION_CELLS);
+    m_aliveCount[g] = FORMATION_CELLS;
+    m_firstColumn[g] = 0;
+    m_lastColumn[g] = FORMATION_COLUMNS - 1;
+    m_lastRow[g] = FORMATION_ROWS - 1;
+    for (int s = 0; s < PLAYER_BULLET_SLOTS; ++s) m_bulletY[s * m_games + g] = INACTIVE_PLAYER_BULLET_Y;
+    for (int s = 0; s < ENEMY_BULLET_SLOTS; ++s) m_enemyBulletY[s * m_games + g] = INACTIVE_ENEMY_BULLET_Y;
+}
+
+std::uint32_t BatchEnv::nextRandom(std::size_t g) {
+    std::uint32_t x = m_rng[g];
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    return m_rng[g] = x;
+}
+
+void BatchEnv::step(const std::uint8_t* actions, float deltaTime) {
+    const std::size_t n = m_games;
+    const float maxPlayerX = SCREEN_WIDTH - m_playerSize.x;
+
+    // --- Jądra wektorowe: gracz, odliczania i ruch pocisków we wszystkich grach naraz ---
+    for (std::size_t g = 0; g < n; ++g) {
+        const float direction = static_cast<float>((actions[g] >> 1) & 1u) - static_cast<float>(actions[g] & 1u);
+        m_prevPlayerX[g] = m_playerX[g];
+        m_playerX[g] = std::min(std::max(m_playerX[g] + direction * PLAYER_SPEED * deltaTime, 0.f), maxPlayerX);
+        m_sinceShot[g] += deltaTime;
+        m_enemyCooldown[g] += deltaTime;
+        m_reward[g] = 0;
+        m_done[g] = 0;
+    }
+
+    // Strzał gracza trafia do pierwszego wolnego slotu i rusza jeszcze w tym kroku (jak fireBullet przed stepGame)
+    for (std::size_t g = 0; g < n; ++g) {
+        if (!(actions[g] & Fire) || m_sinceShot[g] < PLAYER_SHOOT_INTERVAL) continue;
+        for (int s = 0; s < PLAYER_BULLET_SLOTS; ++s) {
+            const std::size_t i = s * n + g;
+            if (m_bulletY[i] + m_bulletSize.y >= 0.f) continue;
+            m_bulletX[i] = m_playerX[g] + m_playerSize.x / 2.0f - m_bulletSize.x / 2.0f;
+            m_bulletY[i] = m_playerY - m_bulletSize.y;
+            m_sinceShot[g] = 0.f;
+            break;
+        }
+    }
+
+    const float bulletStep = BULLET_SPEED * deltaTime;
+    for (std::size_t i = 0; i < m_bulletY.size(); ++i) m_bulletY[i] -= bulletStep;
+    const float enemyBulletStep = ENEMY_BULLET_SPEED * deltaTime;
+    for (std::size_t i = 0; i < m_enemyBulletY.size(); ++i) m_enemyBulletY[i] += enemyBulletStep;
+
+    // --- Część skalarna: formacja, strzały wrogów i trafienia (rozgałęzienia per gra) ---
+    for (std::size_t g = 0; g < n; ++g) {
+        const std::uint64_t* alive = &m_alive[g * m_words];
+
+        // Krawędzie i dno liczone dla skrajnych żywych kolumn/wierszy
+        const float left = m_formationX[g] + m_firstColumn[g] * m_spacing.x;
+        const float right = m_formationX[g] + m_lastColumn[g] * m_spacing.x + m_enemySize.x;
+        const bool drop = (m_direction[g] > 0 && right >= SCREEN_WIDTH - 5.f) || (m_direction[g] < 0 && left <= 5.f);
+        bool lost = false;
+        if (drop) {
+            m_direction[g] = -m_direction[g];
+        } else {
+            lost = m_formationY[g] + m_lastRow[g] * m_spacing.y + m_enemySize.y >= SCREEN_HEIGHT - 50.f;
+        }
+
+        if (!lost) {
+            const sf::Vector2f formationStep(ENEMY_SPEED * m_direction[g] * deltaTime, drop ? ENEMY_DROP_DISTANCE : 0.f);
+            m_formationX[g] += formationStep.x;
+            m_formationY[g] += formationStep.y;
+
+            if (m_enemyCooldown[g] >= ENEMY_SHOOT_INTERVAL) {
+                fireEnemyBullet(g);
+                m_enemyCooldown[g] = 0.f;
+            }
+            if (ActiveConfig::BULLET_INTERCEPTION) interceptBullets(g, deltaTime);
+            lost = playerHit(g, deltaTime);
+            if (!lost) {
+                collidePlayerBullets(g, formationStep, deltaTime);
+
+                // Zderzenie gracza z formacją
+                int c0, c1, r0, r1;
+                cellRange(m_playerX[g], m_playerX[g] + m_playerSize.x, m_formationX[g], m_enemySize.x, m_spacing.x, FORMATION_COLUMNS, c0, c1);
+                cellRange(m_playerY, m_playerY + m_playerSize.y, m_formationY[g], m_enemySize.y, m_spacing.y, FORMATION_ROWS, r0, r1);
+                for (int r = r0; r <= r1 && !lost; ++r) {
+                    for (int c = c0; c <= c1 && !lost; ++c) {
+                        if (!cellBit(alive, r * FORMATION_COLUMNS + c)) continue;
+                        lost = masksOverlap(*m_playerMask, Vec2(Scalar(m_playerX[g]), Scalar(m_playerY)), *m_enemyMask,
+                                            Vec2(Scalar(m_formationX[g] + c * m_spacing.x), Scalar(m_formationY[g] + r * m_spacing.y)));
+                    }
+                }
+            }
+        }
+
+        if (lost) {
+            m_done[g] = 1;
+            ++m_episodes;
+            m_episodeScoreSum += m_score[g];
+            resetGameAt(g);
+        } else if (m_aliveCount[g] == 0) {
+            ++m_wavesCleared;
+            resetWaveAt(g);
+        }
+    }
+}
+
+void BatchEnv::fireEnemyBullet(std::size_t g) {
+    const int count = m_aliveCount[g];
+    if (count == 0) return;
+
+    // Losowy żywy wróg: k-ty ustawiony bit (całe słowa przeskakiwane po liczbie bitów)
+    const std::uint64_t* alive = &m_alive[g * m_words];
+    int k = static_cast<int>(nextRandom(g) % static_cast<std::uint32_t>(count));
+    std::size_t w = 0;
+    for (; k >= std::popcount(alive[w]); ++w) k -= std::popcount(alive[w]);
+    std::uint64_t bits = alive[w];
+    for (; k > 0; --k) bits &= bits - 1;
+    const int cell = static_cast<int>(w * 64) + std::countr_zero(bits);
+    const float enemyLeft = m_formationX[g] + (cell % FORMATION_COLUMNS) * m_spacing.x;
+    const float enemyTop = m_formationY[g] + (cell / FORMATION_COLUMNS) * m_spacing.y;
+
+    for (int s = 0; s < ENEMY_BULLET_SLOTS; ++s) {
+        const std::size_t i = s * m_games + g;
+        if (m_enemyBulletY[i] <= SCREEN_HEIGHT) continue;
+        m_enemyBulletX[i] = enemyLeft + m_enemySize.x / 2.0f - m_enemyBulletSize.x / 2.0f;
+        m_enemyBulletY[i] = enemyTop + m_enemySize.y;
+        return;
+    }
+}
+
+bool BatchEnv::playerHit(std::size_t g, float deltaTime) {
+    const sf::FloatRect player(m_playerX[g], m_playerY, m_playerSize.x, m_playerSize.y);
+    const sf::Vector2f playerStep(m_playerX[g] - m_prevPlayerX[g], 0.f);
+    const sf::Vector2f bulletStep(0.f, ENEMY_BULLET_SPEED * deltaTime);
+    for (int s = 0; s < ENEMY_BULLET_SLOTS; ++s) {
+        const std::size_t i = s * m_games + g;
+        const float y = m_enemyBulletY[i];
+        // Szybkie odrzucenie w pionie (obejmuje też wolne sloty)
+        if (y + m_enemyBulletSize.y < m_playerY || y - bulletStep.y > m_playerY + m_playerSize.y) continue;
+        const sf::FloatRect bullet(m_enemyBulletX[i], y, m_enemyBulletSize.x, m_enemyBulletSize.y);
+        if (firstContact(*m_enemyBulletMask, Rect(bullet), Vec2(bulletStep), *m_playerMask, Rect(player), Vec2(playerStep)) >= Scalar(0)) {
+            m_enemyBulletY[i] = INACTIVE_ENEMY_BULLET_Y;
+            return true;
+        }
+    }
+    return false;
+}
+
+// Pociski gracza i wrogów, które spotkały się w kroku, znikają parami, każdy pocisk raz (jak w stepGame,
+// ale pary w kolejności slotów zamiast miotły po x; pule są małe, więc wystarczy każdy z każdym)
+void BatchEnv::interceptBullets(std::size_t g, float deltaTime) {
+    const sf::Vector2f bulletStep(0.f, -BULLET_SPEED * deltaTime);
+    const sf::Vector2f enemyBulletStep(0.f, ENEMY_BULLET_SPEED * deltaTime);
+    for (int s = 0; s < PLAYER_BULLET_SLOTS; ++s) {
+        const std::size_t i = s * m_games + g;
+        const float y = m_bulletY[i];
+        if (y + m_bulletSize.y < 0.f) continue;
+        const float x = m_bulletX[i];
+        for (int e = 0; e < ENEMY_BULLET_SLOTS; ++e) {
+            const std::size_t j = e * m_games + g;
+            const float enemyY = m_enemyBulletY[j];
+            const float enemyX = m_enemyBulletX[j];
+            // Odrzucenie po torach w kroku (obejmuje też wolne sloty); pociski lecą tylko w pionie
+            if (enemyY > SCREEN_HEIGHT || enemyY + m_enemyBulletSize.y < y ||
+                enemyY - enemyBulletStep.y > y + m_bulletSize.y - bulletStep.y ||
+                enemyX + m_enemyBulletSize.x < x || enemyX > x + m_bulletSize.x) continue;
+            const sf::FloatRect bullet(x, y, m_bulletSize.x, m_bulletSize.y);
+            const sf::FloatRect enemyBullet(enemyX, enemyY, m_enemyBulletSize.x, m_enemyBulletSize.y);
+            if (firstContact(*m_bulletMask, Rect(bullet), Vec2(bulletStep), *m_enemyBulletMask, Rect(enemyBullet), Vec2(enemyBulletStep)) >= Scalar(0)) {
+                m_bulletY[i] = INACTIVE_PLAYER_BULLET_Y;
+                m_enemyBulletY[j] = INACTIVE_ENEMY_BULLET_Y;
+                break;
+            }
+        }
+    }
+}
+
+void BatchEnv::collidePlayerBullets(std::size_t g, sf::Vector2f formationStep, float deltaTime) {
+    const sf::Vector2f bulletStep(0.f, -BULLET_SPEED * deltaTime);
+    for (int s = 0; s < PLAYER_BULLET_SLOTS; ++s) {
+        const std::size_t i = s * m_games + g;
+        const float y = m_bulletY[i];
+        if (y + m_bulletSize.y < 0.f) continue;
+        const float x = m_bulletX[i];
+
+        // Komórki, przez które mógł przejść pocisk w tym kroku (z zapasem na ruch formacji)
+        int c0, c1, r0, r1;
+        cellRange(x - std::abs(formationStep.x), x + m_bulletSize.x + std::abs(formationStep.x),
+                  m_formationX[g], m_enemySize.x, m_spacing.x, FORMATION_COLUMNS, c0, c1);
+        cellRange(y - formationStep.y, y + m_bulletSize.y - bulletStep.y + formationStep.y,
+                  m_formationY[g], m_enemySize.y, m_spacing.y, FORMATION_ROWS, r0, r1);
+
+        // Najwcześniejsze trafienie w kroku, jak w stepGame
+        const sf::FloatRect bullet(x, y, m_bulletSize.x, m_bulletSize.y);
+        int hitCell = -1;
+        float earliestHit = 2.f;
+        for (int r = r0; r <= r1; ++r) {
+            for (int c = c0; c <= c1; ++c) {
+                const int cell = r * FORMATION_COLUMNS + c;
+                if (!cellBit(&m_alive[g * m_words], cell)) continue;
+                const sf::FloatRect enemy(m_formationX[g] + c * m_spacing.x, m_formationY[g] + r * m_spacing.y, m_enemySize.x, m_enemySize.y);
+                const float t = static_cast<float>(firstContact(*m_bulletMask, Rect(bullet), Vec2(bulletStep), *m_enemyMask, Rect(enemy), Vec2(formationStep)));
+                if (t >= 0.f && t < earliestHit) {
+                    earliestHit = t;
+                    hitCell = cell;
+                }
+            }
+        }
+        if (hitCell >= 0) {
+            std::uint64_t* alive = &m_alive[g * m_words];
+            clearCellBit(alive, hitCell);
+            int firstRow;
+            m_aliveCount[g] = aliveRange(alive, FORMATION_CELLS, FORMATION_COLUMNS, m_firstColumn[g], m_lastColumn[g], firstRow, m_lastRow[g]);
+            m_bulletY[i] = INACTIVE_PLAYER_BULLET_Y;
+            m_score[g] += 10;
+            m_reward[g] += 10;
+        }
+    }
+}
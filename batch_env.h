@@ -0,0 +1,99 @@
+﻿#pragma once
+#include <SFML/Graphics.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "game.h"
+
+// Pociski jednej strony w locie naraz: przelot przez ekran (krótszy niż SCREEN_HEIGHT / speed) podzielony
+// przez odstęp strzałów, w górę, plus jeden na krok, w którym stary pocisk jeszcze nie zwolnił slotu
+constexpr int bulletsInFlight(float speed, float shootInterval) {
+    const float shots = ActiveConfig::SCREEN_HEIGHT / (speed * shootInterval);
+    const int whole = static_cast<int>(shots);
+    return whole + (shots > whole ? 1 : 0) + 1;
+}
+
+// --- Środowisko wsadowe: N gier krokowanych razem (lockstep) ---
+// Stan wszystkich gier leży w tablicach SoA indeksowanych numerem gry, więc pętle ruchu i odliczania
+// idą po ciągłej pamięci i kompilator może je wektoryzować w poprzek gier. Formacja to bitset
+// (cellBit, komórka row * FORMATION_COLUMNS + col) plus lewy górny róg, pociski są w stałych pulach slotów.
+// Reguły są jak w stepGame (swept AABB + maski przy trafieniach, przechwytywanie pocisków), bez cząsteczek i encji.
+// Wyjątek: skrypty wrogów (Config::ENEMY_SCRIPTS) nie są modelowane. Co ENEMY_SHOOT_INTERVAL pada jeden
+// prosty strzał losowego wroga, bez serii, wachlarzy i nurkujących, więc przy włączonych skryptach
+// gra jest trudniejsza niż środowisko, a boty z niego trzeba sprawdzać w --headless.
+// Gra kończąca się w kroku jest od razu resetowana; done/reward opisują ten krok.
+class BatchEnv {
+public:
+    // Bity akcji gracza na jeden krok
+    enum Action : std::uint8_t {
+        Left = 1,
+        Right = 2,
+        Fire = 4
+    };
+
+    // Rozmiary pul z ActiveConfig: pełna pula gubiłaby strzały, których gra nie gubi
+    static constexpr int PLAYER_BULLET_SLOTS = bulletsInFlight(ActiveConfig::BULLET_SPEED, ActiveConfig::PLAYER_SHOOT_INTERVAL);
+    static constexpr int ENEMY_BULLET_SLOTS = bulletsInFlight(ActiveConfig::ENEMY_BULLET_SPEED, ActiveConfig::ENEMY_SHOOT_INTERVAL);
+
+    BatchEnv(std::size_t games, const GameAssets& assets, std::uint32_t seed);
+
+    std::size_t size() const { return m_games; }
+
+    // actions: size() bajtów z bitami Action
+    void step(const std::uint8_t* actions, float deltaTime);
+
+    // --- Obserwacje (indeks = numer gry) ---
+    const std::vector<float>& playerX() const { return m_playerX; }
+    const std::vector<float>& formationX() const { return m_formationX; }
+    const std::vector<float>& formationY() const { return m_formationY; }
+    // Bitset żywych komórek: formationWords() słów na grę, gra g od słowa g * formationWords()
+    const std::vector<std::uint64_t>& formationAlive() const { return m_alive; }
+    std::size_t formationWords() const { return m_words; }
+    const std::vector<std::int32_t>& score() const { return m_score; }
+    const std::vector<std::int32_t>& reward() const { return m_reward; } // Punkty zdobyte w ostatnim kroku
+    const std::vector<std::uint8_t>& done() const { return m_done; }     // 1: gra skończyła się w ostatnim kroku
+
+    // --- Statystyki zakończonych gier ---
+    std::uint64_t episodes() const { return m_episodes; }
+    std::int64_t episodeScoreSum() const { return m_episodeScoreSum; }
+    std::uint64_t wavesCleared() const { return m_wavesCleared; }
+
+private:
+    void resetGameAt(std::size_t g);
+    void resetWaveAt(std::size_t g);
+    std::uint32_t nextRandom(std::size_t g);
+    void fireEnemyBullet(std::size_t g);
+    void collidePlayerBullets(std::size_t g, sf::Vector2f formationStep, float deltaTime);
+    bool playerHit(std::size_t g, float deltaTime);
+    void interceptBullets(std::size_t g, float deltaTime);
+
+    std::size_t m_games;
+    std::size_t m_words; // Słowa bitsetu formacji na grę
+
+    // Geometria wspólna dla wszystkich gier
+    sf::Vector2f m_playerSize, m_enemySize, m_bulletSize, m_enemyBulletSize;
+    sf::Vector2f m_spacing;
+    float m_playerY;
+    const CollisionMask* m_playerMask;
+    const CollisionMask* m_enemyMask;
+    const CollisionMask* m_bulletMask;
+    const CollisionMask* m_enemyBulletMask;
+
+    // Stan gier (SoA)
+    std::vector<float> m_playerX, m_prevPlayerX, m_sinceShot;
+    std::vector<float> m_formationX, m_formationY, m_direction, m_enemyCooldown;
+    std::vector<std::uint64_t> m_alive; // [g * m_words + w]
+    // Liczba żywych i zasięg ich kolumn i wierszy, przeliczane tylko przy trafieniu
+    std::vector<std::int32_t> m_aliveCount, m_firstColumn, m_lastColumn, m_lastRow;
+    std::vector<std::uint32_t> m_rng;
+    std::vector<std::int32_t> m_score, m_reward;
+    std::vector<std::uint8_t> m_done;
+
+    // Pule pocisków [slot * games + g]; wolny slot ma y poza ekranem, więc ruch nie potrzebuje flag
+    std::vector<float> m_bulletX, m_bulletY;
+    std::vector<float> m_enemyBulletX, m_enemyBulletY;
+
+    std::uint64_t m_episodes = 0;
+    std::int64_t m_episodeScoreSum = 0;
+    std::uint64_t m_wavesCleared = 0;
+};
@@ -0,0 +1,11 @@
+﻿#pragma once
+#include <cstdint>
+
+// --- Wbudowana czcionka bitmapowa 5x7 (dla rysowania bez FreeType i OpenGL) ---
+// Znaki ' '..'Z'; małe litery są rysowane jak wielkie, pozostałe znaki jako puste pole.
+// Wiersz glifu to 5 bitów, najstarszy z nich jest lewą kolumną.
+const int GLYPH_WIDTH = 5;
+const int GLYPH_HEIGHT = 7;
+const int GLYPH_ADVANCE = 6; // Szerokość znaku z odstępem, w pikselach glifu
+
+const std::uint8_t* glyphRows(char c);
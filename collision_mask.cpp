@@ -0,0 +1,142 @@
+﻿#include "collision_mask.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+
+namespace {
+int floorDiv64(int value) {
+    return value >= 0 ? value / 64 : -((-value + 63) / 64);
+}
+} // namespace
+
+CollisionMask CollisionMask::fromAlpha(const sf::Image& image, sf::Vector2u size, sf::Uint8 alphaThreshold) {
+    const sf::Vector2u sourceSize = image.getSize();
+    const sf::Uint8* pixels = image.getPixelsPtr();
+    std::vector<char> solid(sourceSize.x * sourceSize.y);
+    for (std::size_t i = 0; i < solid.size(); ++i) solid[i] = pixels[i * 4 + 3] >= alphaThreshold;
+    return downsample(solid, sourceSize, size);
+}
+
+CollisionMask CollisionMask::fromColorKey(const sf::Image& image, sf::Vector2u size, sf::Color keyColor, int tolerance) {
+    const sf::Vector2u sourceSize = image.getSize();
+    const sf::Uint8* pixels = image.getPixelsPtr();
+    const std::size_t count = sourceSize.x * sourceSize.y;
+
+    auto nearKey = [&](std::size_t i) {
+        const sf::Uint8* p = pixels + i * 4;
+        return std::abs(p[0] - keyColor.r) <= tolerance &&
+               std::abs(p[1] - keyColor.g) <= tolerance &&
+               std::abs(p[2] - keyColor.b) <= tolerance;
+    };
+
+    // Wypełnianie tła od krawędzi obrazu (stos zamiast rekurencji)
+    std::vector<char> background(count, 0);
+    std::vector<std::size_t> stack;
+    auto seed = [&](std::size_t i) {
+        if (!background[i] && nearKey(i)) {
+            background[i] = 1;
+            stack.push_back(i);
+        }
+    };
+    for (unsigned int x = 0; x < sourceSize.x; ++x) {
+        seed(x);
+        seed((sourceSize.y - 1) * sourceSize.x + x);
+    }
+    for (unsigned int y = 0; y < sourceSize.y; ++y) {
+        seed(y * sourceSize.x);
+        seed(y * sourceSize.x + sourceSize.x - 1);
+    }
+    while (!stack.empty()) {
+        const std::size_t i = stack.back();
+        stack.pop_back();
+        const unsigned int x = i % sourceSize.x;
+        const unsigned int y = i / sourceSize.x;
+        if (x > 0) seed(i - 1);
+        if (x + 1 < sourceSize.x) seed(i + 1);
+        if (y > 0) seed(i - sourceSize.x);
+        if (y + 1 < sourceSize.y) seed(i + sourceSize.x);
+    }
+
+    std::vector<char> solid(count);
+    for (std::size_t i = 0; i < count; ++i) solid[i] = !background[i] && pixels[i * 4 + 3] >= 128;
+    return downsample(solid, sourceSize, size);
+}
+
+CollisionMask CollisionMask::downsample(const std::vector<char>& solid, sf::Vector2u sourceSize, sf::Vector2u size) {
+    CollisionMask mask;
+    if (size.x == 0 || size.y == 0 || sourceSize.x == 0 || sourceSize.y == 0) return mask;
+    mask.m_width = size.x;
+    mask.m_height = size.y;
+    mask.m_wordsPerRow = (size.x + 63) / 64;
+    mask.m_bits.assign(mask.m_wordsPerRow * size.y, 0);
+
+    // Pokrycie każdej komórki docelowej: liczba pełnych / wszystkich pikseli źródła
+    std::vector<unsigned int> solidCount(size.x * size.y, 0);
+    std::vector<unsigned int> totalCount(size.x * size.y, 0);
+    for (unsigned int sy = 0; sy < sourceSize.y; ++sy) {
+        const unsigned int ty = sy * size.y / sourceSize.y;
+        for (unsigned int sx = 0; sx < sourceSize.x; ++sx) {
+            const unsigned int cell = ty * size.x + sx * size.x / sourceSize.x;
+            ++totalCount[cell];
+            solidCount[cell] += solid[sy * sourceSize.x + sx] ? 1 : 0;
+        }
+    }
+
+    for (unsigned int ty = 0; ty < size.y; ++ty) {
+        for (unsigned int tx = 0; tx < size.x; ++tx) {
+            const unsigned int cell = ty * size.x + tx;
+            bool full;
+            if (totalCount[cell] > 0) {
+                full = solidCount[cell] * 2 >= totalCount[cell];
+            } else { // Powiększanie: najbliższy piksel źródła
+                full = solid[(ty * sourceSize.y / size.y) * sourceSize.x + tx * sourceSize.x / size.x] != 0;
+            }
+            if (full) mask.m_bits[ty * mask.m_wordsPerRow + tx / 64] |= std::uint64_t(1) << (tx % 64);
+        }
+    }
+    return mask;
+}
+
+bool CollisionMask::test(int x, int y) const {
+    if (x < 0 || y < 0 || x >= static_cast<int>(m_width) || y >= static_cast<int>(m_height)) return false;
+    return (m_bits[y * m_wordsPerRow + x / 64] >> (x % 64)) & 1;
+}
+
+std::uint64_t CollisionMask::extractWord(int row, int bitOffset) const {
+    const std::uint64_t* words = &m_bits[row * m_wordsPerRow];
+    const int wordIndex = floorDiv64(bitOffset);
+    const int shift = bitOffset - wordIndex * 64; // 0..63
+    auto wordAt = [&](int i) -> std::uint64_t {
+        return (i >= 0 && i < static_cast<int>(m_wordsPerRow)) ? words[i] : 0;
+    };
+    const std::uint64_t low = wordAt(wordIndex) >> shift;
+    const std::uint64_t high = shift ? wordAt(wordIndex + 1) << (64 - shift) : 0;
+    return low | high;
+}
+
+bool CollisionMask::overlaps(const CollisionMask& a, sf::Vector2i aPos, const CollisionMask& b, sf::Vector2i bPos) {
+    const int top = std::max(aPos.y, bPos.y);
+    const int bottom = std::min(aPos.y + static_cast<int>(a.m_height), bPos.y + static_cast<int>(b.m_height));
+    const int left = std::max(aPos.x, bPos.x);
+    const int right = std::min(aPos.x + static_cast<int>(a.m_width), bPos.x + static_cast<int>(b.m_width));
+    if (top >= bottom || left >= right) return false;
+
+    // Słowa maski A pokrywające część wspólną; kolumna c maski A to kolumna c + dx maski B
+    const int firstWord = (left - aPos.x) / 64;
+    const int lastWord = (right - aPos.x - 1) / 64;
+    const int dx = aPos.x - bPos.x;
+    for (int y = top; y < bottom; ++y) {
+        const std::uint64_t* aRow = &a.m_bits[(y - aPos.y) * a.m_wordsPerRow];
+        const int bRow = y - bPos.y;
+        for (int w = firstWord; w <= lastWord; ++w) {
+            if (aRow[w] & b.extractWord(bRow, w * 64 + dx)) return true;
+        }
+    }
+    return false;
+}
+
+bool masksOverlap(const CollisionMask& a, Vec2 aPos, const CollisionMask& b, Vec2 bPos) {
+    if (a.empty() || b.empty()) return true;
+    return CollisionMask::overlaps(a, sf::Vector2i(roundToInt(aPos.x), roundToInt(aPos.y)),
+                                   b, sf::Vector2i(roundToInt(bPos.x), roundToInt(bPos.y)));
+}
@@ -0,0 +1,45 @@
+﻿#pragma once
+#include <SFML/Graphics.hpp>
+#include <cstdint>
+#include <vector>
+#include "fixed_point.h"
+
+// --- Maska kolizji 1-bitowa ---
+// Budowana raz przy ładowaniu tekstury, od razu w rozdzielczości ekranowej (po skalowaniu sprite'a).
+// Wiersz to ciąg słów 64-bitowych (bit i słowa w = kolumna 64*w + i), bity poza szerokością są zerami,
+// dzięki czemu test nakładania to AND przesuniętych słów zamiast porównywania pikseli.
+class CollisionMask {
+public:
+    CollisionMask() = default;
+
+    // Piksel pełny, gdy alfa >= alphaThreshold (PNG z przezroczystością)
+    static CollisionMask fromAlpha(const sf::Image& image, sf::Vector2u size, sf::Uint8 alphaThreshold = 128);
+
+    // Dla obrazów bez alfy (enemy.jpg): tło to piksele bliskie keyColor połączone z krawędzią obrazu,
+    // więc jasne fragmenty wewnątrz statku pozostają pełne.
+    static CollisionMask fromColorKey(const sf::Image& image, sf::Vector2u size, sf::Color keyColor, int tolerance);
+
+    unsigned int width() const { return m_width; }
+    unsigned int height() const { return m_height; }
+    bool empty() const { return m_bits.empty(); }
+    bool test(int x, int y) const;
+
+    // Czy maski ustawione lewymi górnymi rogami w aPos i bPos mają wspólny pełny piksel
+    static bool overlaps(const CollisionMask& a, sf::Vector2i aPos, const CollisionMask& b, sf::Vector2i bPos);
+
+private:
+    // Zmniejsza mapę pełnych pikseli źródła do size; komórka jest pełna przy pokryciu >= 50%
+    static CollisionMask downsample(const std::vector<char>& solid, sf::Vector2u sourceSize, sf::Vector2u size);
+
+    // 64 bity wiersza zaczynając od kolumny bitOffset (może być ujemna); poza wierszem zera
+    std::uint64_t extractWord(int row, int bitOffset) const;
+
+    unsigned int m_width = 0;
+    unsigned int m_height = 0;
+    unsigned int m_wordsPerRow = 0;
+    std::vector<std::uint64_t> m_bits;
+};
+
+// Wąska faza po pozytywnym teście AABB; pozycje zaokrąglane do pikseli ekranu.
+// Pusta maska (brak danych) oznacza pełny prostokąt, czyli zachowanie jak sam AABB.
+bool masksOverlap(const CollisionMask& a, Vec2 aPos, const CollisionMask& b, Vec2 bPos);
@@ -0,0 +1,316 @@
+﻿#pragma once
+#include <SFML/Graphics.hpp>
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <tuple>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "fixed_point.h"
+
+// --- Komponenty ---
+// Pozycja to zawsze lewy górny róg obiektu (tak jak dla sf::Sprite bez originu).
+// Geometria jest w Scalar (fixed_point.h), żeby tryb stałoprzecinkowy obejmował cały ruch i kolizje.
+struct Transform {
+    Vec2 position;
+};
+
+struct Velocity {
+    Vec2 value;
+};
+
+// Rozmiar prostokąta kolizji/rysowania w pikselach ekranu (już po skalowaniu).
+struct Bounds {
+    Vec2 size;
+};
+
+enum class TextureId : std::uint8_t { Player, Enemy, Bullet, EnemyBullet, Count };
+
+struct Renderable {
+    TextureId texture = TextureId::Count;
+    sf::Color color = sf::Color::White;
+    float radius = 0.f; // > 0: rysowane jako koło (cząsteczki), tekstura ignorowana
+};
+
+struct Lifetime {
+    float remaining;
+};
+
+enum class Team : std::uint8_t { Player, Enemy };
+
+// --- Encje ---
+struct Entity {
+    std::uint32_t index = 0;
+    std::uint32_t generation = 0;
+};
+
+inline bool operator==(Entity a, Entity b) { return a.index == b.index && a.generation == b.generation; }
+inline bool operator!=(Entity a, Entity b) { return !(a == b); }
+
+using ComponentMask = std::uint32_t;
+
+// Znacznik wykluczenia dla zapytań: world.each<A, B>(Without<C>{}, f)
+template <typename... Cs>
+struct Without {};
+
+namespace detail {
+template <typename T, typename... Ts>
+struct TypeIndex;
+
+template <typename T, typename... Ts>
+struct TypeIndex<T, T, Ts...> { static constexpr std::size_t value = 0; };
+
+template <typename T, typename U, typename... Ts>
+struct TypeIndex<T, U, Ts...> { static constexpr std::size_t value = 1 + TypeIndex<T, Ts...>::value; };
+
+using Expand = int[];
+} // namespace detail
+
+// --- Świat (archetypy z kolumnami komponentów) ---
+// Encje o tym samym zestawie komponentów leżą w jednym archetypie, a każdy komponent
+// w osobnym, ciągłym std::vector. Systemy iterują więc po gęstych tablicach zamiast po std::list.
+template <typename... Components>
+class BasicWorld {
+public:
+    static_assert(sizeof...(Components) <= 32, "ComponentMask ma 32 bity");
+
+    template <typename... Cs>
+    static constexpr ComponentMask maskOf() {
+        ComponentMask mask = 0;
+        (void)detail::Expand{0, (mask |= ComponentMask(1) << detail::TypeIndex<Cs, Components...>::value, 0)...};
+        return mask;
+    }
+
+    // --- Bufor komend (odroczone spawny i usunięcia) ---
+    // Systemy nie modyfikują struktury świata w trakcie iteracji; zapisują komendy,
+    // które world.apply() wykonuje w jednym miejscu pod koniec kroku.
+    class CommandBuffer {
+    public:
+        template <typename... Cs>
+        void spawn(const Cs&... cs) {
+            PendingSpawn pending;
+            pending.mask = maskOf<Cs...>();
+            (void)detail::Expand{0, (std::get<Cs>(pending.values) = cs, 0)...};
+            m_spawns.push_back(pending);
+        }
+
+        void despawn(Entity e) { m_despawns.push_back(e); }
+
+        bool empty() const { return m_spawns.empty() && m_despawns.empty(); }
+
+        // Dopisuje komendy innego bufora na koniec (bufory porcji równoległych scalane w ustalonej kolejności)
+        void append(CommandBuffer& other) {
+            if (empty()) {
+                m_spawns.swap(other.m_spawns); // Bez kopiowania; other dostaje pustą pamięć tego bufora
+                m_despawns.swap(other.m_despawns);
+                return;
+            }
+            m_spawns.insert(m_spawns.end(), other.m_spawns.begin(), other.m_spawns.end());
+            m_despawns.insert(m_despawns.end(), other.m_despawns.begin(), other.m_despawns.end());
+            other.clear();
+        }
+
+        void clear() {
+            m_spawns.clear();
+            m_despawns.clear();
+        }
+
+    private:
+        friend class BasicWorld;
+        struct PendingSpawn {
+            ComponentMask mask;
+            std::tuple<Components...> values;
+        };
+        std::vector<PendingSpawn> m_spawns;
+        std::vector<Entity> m_despawns;
+    };
+
+    template <typename... Cs>
+    Entity spawn(const Cs&... cs) {
+        std::tuple<Components...> values;
+        (void)detail::Expand{0, (std::get<Cs>(values) = cs, 0)...};
+        return spawnWithMask(maskOf<Cs...>(), values);
+    }
+
+    bool isAlive(Entity e) const {
+        return e.index < m_records.size() && m_records[e.index].alive && m_records[e.index].generation == e.generation;
+    }
+
+    void despawn(Entity e) {
+        if (!isAlive(e)) return; // Np. dwa pociski trafiły ten sam cel w jednej klatce
+        EntityRecord& record = m_records[e.index];
+        Archetype& arch = m_archetypes[record.archetype];
+        const std::size_t row = record.row;
+        const std::size_t last = arch.entities.size() - 1;
+        // Swap-remove: ostatni wiersz wskakuje w miejsce usuwanego, kolumny pozostają gęste
+        if (row != last) {
+            arch.entities[row] = arch.entities[last];
+            m_records[arch.entities[row].index].row = static_cast<std::uint32_t>(row);
+        }
+        arch.entities.pop_back();
+        (void)detail::Expand{0, (removeRow<Components>(arch, row, last), 0)...};
+        record.alive = false;
+        ++record.generation;
+        m_freeIndices.push_back(e.index);
+    }
+
+    void apply(CommandBuffer& commands) {
+        for (Entity e : commands.m_despawns) despawn(e);
+        for (const auto& pending : commands.m_spawns) spawnWithMask(pending.mask, pending.values);
+        commands.clear();
+    }
+
+    void clear() {
+        for (auto& arch : m_archetypes) {
+            for (Entity e : arch.entities) {
+                m_records[e.index].alive = false;
+                ++m_records[e.index].generation;
+                m_freeIndices.push_back(e.index);
+            }
+            arch.entities.clear();
+            (void)detail::Expand{0, (std::get<std::vector<Components>>(arch.columns).clear(), 0)...};
+        }
+    }
+
+    // Dostęp do pojedynczej encji (np. gracza); nullptr jeśli encja nie ma komponentu lub nie żyje
+    template <typename T>
+    T* tryGet(Entity e) {
+        if (!isAlive(e)) return nullptr;
+        const EntityRecord& record = m_records[e.index];
+        Archetype& arch = m_archetypes[record.archetype];
+        if (!(arch.mask & maskOf<T>())) return nullptr;
+        return &std::get<std::vector<T>>(arch.columns)[record.row];
+    }
+
+    template <typename T>
+    T& get(Entity e) { return *tryGet<T>(e); }
+
+    // Wywołuje f(Entity, Cs&...) dla każdej encji posiadającej wszystkie Cs
+    template <typename... Cs, typename F>
+    void each(F&& f) {
+        eachMatching<Cs...>(0, f);
+    }
+
+    template <typename... Cs, typename... Excluded, typename F>
+    void each(Without<Excluded...>, F&& f) {
+        eachMatching<Cs...>(maskOf<Excluded...>(), f);
+    }
+
+    // Jak each<Cs...>, ale tylko encje o numerach [begin, end) w kolejności each (podział pętli na porcje).
+    // Nie zmienia struktury świata, więc różne zakresy mogą iść równolegle.
+    template <typename... Cs, typename F>
+    void eachInRange(std::size_t begin, std::size_t end, F&& f) {
+        const ComponentMask required = maskOf<Cs...>();
+        std::size_t first = 0; // Numer pierwszej encji archetypu
+        for (auto& arch : m_archetypes) {
+            if (first >= end) return;
+            if ((arch.mask & required) != required) continue;
+            const std::size_t n = arch.entities.size();
+            if (first + n > begin) {
+                const std::size_t from = begin > first ? begin - first : 0;
+                const std::size_t to = std::min(n, end - first);
+                for (std::size_t i = from; i < to; ++i) f(arch.entities[i], std::get<std::vector<Cs>>(arch.columns)[i]...);
+            }
+            first += n;
+        }
+    }
+
+    template <typename... Cs>
+    std::size_t count() const {
+        const ComponentMask required = maskOf<Cs...>();
+        std::size_t n = 0;
+        for (const auto& arch : m_archetypes)
+            if ((arch.mask & required) == required) n += arch.entities.size();
+        return n;
+    }
+
+private:
+    struct Archetype {
+        ComponentMask mask;
+        std::vector<Entity> entities;
+        std::tuple<std::vector<Components>...> columns; // Kolumny spoza maski pozostają puste
+    };
+
+    struct EntityRecord {
+        std::uint32_t generation = 0;
+        std::uint32_t archetype = 0;
+        std::uint32_t row = 0;
+        bool alive = false;
+    };
+
+    template <typename T>
+    static void removeRow(Archetype& arch, std::size_t row, std::size_t last) {
+        if (!(arch.mask & maskOf<T>())) return;
+        auto& column = std::get<std::vector<T>>(arch.columns);
+        if (row != last) column[row] = column[last];
+        column.pop_back();
+    }
+
+    template <typename T>
+    static void pushRow(Archetype& arch, const std::tuple<Components...>& values) {
+        if (arch.mask & maskOf<T>()) std::get<std::vector<T>>(arch.columns).push_back(std::get<T>(values));
+    }
+
+    std::uint32_t archetypeFor(ComponentMask mask) {
+        // Spawny przychodzą seriami tego samego rodzaju (cząsteczki eksplozji, odtwarzanie migawki)
+        if (mask == m_lastMask && !m_archetypes.empty()) return m_lastArchetype;
+        m_lastMask = mask;
+        auto found = m_archetypeByMask.find(mask);
+        if (found != m_archetypeByMask.end()) return m_lastArchetype = found->second;
+        Archetype arch;
+        arch.mask = mask;
+        m_archetypes.push_back(std::move(arch));
+        const auto index = static_cast<std::uint32_t>(m_archetypes.size() - 1);
+        m_archetypeByMask.emplace(mask, index);
+        return m_lastArchetype = index;
+    }
+
+    Entity spawnWithMask(ComponentMask mask, const std::tuple<Components...>& values) {
+        Entity e;
+        if (!m_freeIndices.empty()) {
+            e.index = m_freeIndices.back();
+            m_freeIndices.pop_back();
+        } else {
+            e.index = static_cast<std::uint32_t>(m_records.size());
+            m_records.emplace_back();
+        }
+        EntityRecord& record = m_records[e.index];
+        e.generation = record.generation;
+        record.alive = true;
+        record.archetype = archetypeFor(mask);
+        Archetype& arch = m_archetypes[record.archetype];
+        record.row = static_cast<std::uint32_t>(arch.entities.size());
+        arch.entities.push_back(e);
+        (void)detail::Expand{0, (pushRow<Components>(arch, values), 0)...};
+        return e;
+    }
+
+    template <typename F, typename... Columns>
+    static void eachRow(const std::vector<Entity>& entities, F& f, Columns*... columns) {
+        const std::size_t n = entities.size();
+        for (std::size_t i = 0; i < n; ++i) f(entities[i], columns[i]...);
+    }
+
+    template <typename... Cs, typename F>
+    void eachMatching(ComponentMask excluded, F& f) {
+        const ComponentMask required = maskOf<Cs...>();
+        for (auto& arch : m_archetypes) {
+            if ((arch.mask & required) != required || (arch.mask & excluded)) continue;
+            if (arch.entities.empty()) continue;
+            eachRow(arch.entities, f, std::get<std::vector<Cs>>(arch.columns).data()...);
+        }
+    }
+
+    std::vector<Archetype> m_archetypes;
+    std::unordered_map<ComponentMask, std::uint32_t> m_archetypeByMask;
+    ComponentMask m_lastMask = 0;       // Ostatnio użyty archetyp (pomija hash przy serii spawnów)
+    std::uint32_t m_lastArchetype = 0;
+    std::vector<EntityRecord> m_records;
+    std::vector<std::uint32_t> m_freeIndices;
+};
+
+using World = BasicWorld<Transform, Velocity, Bounds, Renderable, Lifetime, Team>;
+using CommandBuffer = World::CommandBuffer;
+
+inline Rect worldBounds(const Transform& t, const Bounds& b) { return Rect(t.position, b.size); }
@@ -0,0 +1,199 @@
+﻿#include "enemy_script.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <new>
+#include "game.h"
+#include "options.h"
+
+void* ScriptFramePool::allocate(std::size_t size) noexcept {
+    m_largestFrame = std::max(m_largestFrame, size);
+    if (size > FRAME_SIZE - HEADER_SIZE) return nullptr;
+    if (!m_blocks) {
+        m_blocks.reset(new (std::nothrow) Block[m_capacity]);
+        if (!m_blocks) return nullptr;
+        for (std::size_t i = m_capacity; i-- > 0;) {
+            m_blocks[i].nextFree = m_free;
+            m_free = &m_blocks[i];
+        }
+    }
+    if (!m_free) return nullptr;
+    Block* block = m_free;
+    m_free = block->nextFree;
+    ++m_used;
+    *reinterpret_cast<ScriptFramePool**>(block->bytes) = this;
+    return block->bytes + HEADER_SIZE;
+}
+
+void ScriptFramePool::deallocate(void* frame) noexcept {
+    unsigned char* bytes = static_cast<unsigned char*>(frame) - HEADER_SIZE;
+    ScriptFramePool* pool = *reinterpret_cast<ScriptFramePool**>(bytes);
+    Block* block = reinterpret_cast<Block*>(bytes);
+    block->nextFree = pool->m_free;
+    pool->m_free = block;
+    --pool->m_used;
+}
+
+namespace {
+const std::uint32_t SLOT_BITS = 16;
+const std::uint32_t SLOT_MASK = (1u << SLOT_BITS) - 1;
+} // namespace
+
+EnemyScripts::EnemyScripts(std::size_t capacity) : m_pool(std::min(capacity, MAX_SLOTS)) {
+    m_context.scripts = this;
+}
+
+EnemyScripts::EnemyScripts(const EnemyScripts& other) : EnemyScripts(other.m_pool.capacity()) {
+    inheritGenerations(other);
+}
+
+EnemyScripts& EnemyScripts::operator=(const EnemyScripts& other) {
+    if (this != &other) {
+        clear();
+        inheritGenerations(other);
+    }
+    return *this;
+}
+
+void EnemyScripts::inheritGenerations(const EnemyScripts& other) {
+    m_generations = other.m_generations;
+    for (std::uint8_t& generation : m_generations) ++generation;
+    m_restartPending = true;
+}
+
+bool EnemyScripts::adopt(EnemyScript script) {
+    if (!script) return false;
+    std::uint32_t slot;
+    if (!m_freeSlots.empty()) {
+        slot = m_freeSlots.back();
+        m_freeSlots.pop_back();
+    } else {
+        slot = static_cast<std::uint32_t>(m_slots.size());
+        m_slots.emplace_back();
+        if (m_generations.size() <= slot) m_generations.push_back(0);
+    }
+    m_slots[slot] = std::move(script);
+    m_nextStep.push_back(slot);
+    ++m_running;
+    return true;
+}
+
+void EnemyScripts::update(Game& game, const GameAssets& assets, const std::vector<std::uint32_t>& timerEvents) {
+    m_context.game = &game;
+    m_context.assets = &assets;
+    if (m_restartPending) { // Nowe skrypty ruszają jeszcze w tym kroku
+        m_restartPending = false;
+        restartEnemyScripts(game);
+    }
+    // Skrypty, które teraz zaczekają na krok, trafią już do nowej listy
+    m_resuming.swap(m_nextStep);
+    for (std::uint32_t event : timerEvents) {
+        if (timerEventKind(event) != TimerEvent::ScriptWake) continue;
+        const std::uint32_t payload = timerEventPayload(event);
+        const std::uint32_t slot = payload & SLOT_MASK;
+        if (slot < m_slots.size() && m_generations[slot] == payload >> SLOT_BITS) resumeSlot(slot);
+    }
+    for (std::uint32_t slot : m_resuming) resumeSlot(slot);
+    m_resuming.clear();
+}
+
+void EnemyScripts::clear() {
+    for (std::uint32_t slot = 0; slot < m_slots.size(); ++slot) {
+        if (m_slots[slot]) ++m_generations[slot];
+    }
+    m_slots.clear(); // Niszczy ramki, bloki wracają do puli
+    m_freeSlots.clear();
+    m_nextStep.clear();
+    m_resuming.clear();
+    m_running = 0;
+}
+
+void EnemyScripts::scheduleWake(std::uint32_t slot, float seconds) {
+    const std::uint32_t payload = slot | static_cast<std::uint32_t>(m_generations[slot]) << SLOT_BITS;
+    m_context.game->timers.schedule(secondsToTicks(seconds), timerEvent(TimerEvent::ScriptWake, payload));
+}
+
+void EnemyScripts::resumeSlot(std::uint32_t slot) {
+    m_context.current = slot;
+    m_slots[slot].resume(); // Skrypt może uruchomić kolejny (start), więc bez referencji do slotu
+    if (m_slots[slot].done()) releaseSlot(slot);
+}
+
+void EnemyScripts::releaseSlot(std::uint32_t slot) {
+    m_slots[slot].reset();
+    ++m_generations[slot];
+    m_freeSlots.push_back(slot);
+    --m_running;
+}
+
+// --- Pomiar kosztu wznowień ---
+namespace {
+const float BENCH_STEP = 1.0f / 60.0f;
+const int BENCH_TIMER_ROUNDS = 4; // Skrypt czekający na timer kończy się po tylu odliczaniach
+
+// Co krok drobna praca na stanie gry, jak sterowanie nurkującym wrogiem
+EnemyScript stepScript(ScriptContext& ctx, int) {
+    for (;;) {
+        co_await EnemyScripts::nextStep(ctx);
+        ++ctx.game->score;
+    }
+}
+
+// Kilka odliczań po delayMs i koniec: nowe skrypty w miejsce skończonych przechodzą przez pulę ramek
+EnemyScript timerScript(ScriptContext& ctx, int delayMs) {
+    for (int round = 0; round < BENCH_TIMER_ROUNDS; ++round) {
+        co_await EnemyScripts::wait(ctx, delayMs / 1000.0f);
+        ++ctx.game->score;
+    }
+}
+} // namespace
+
+int runScriptBenchmark(const LaunchOptions& options) {
+    const std::size_t enemies = static_cast<std::size_t>(options.benchScripts);
+    EnemyScripts scripts(enemies * 2);
+    Game game(options.seed);
+    const GameAssets assets{}; // Skrypty pomiaru nie sięgają po zasoby
+    Pcg32& rng = game.random.stream(RandomStream::Shooter);
+    auto startTimerScript = [&]() { return scripts.start(timerScript, 50 + static_cast<int>(rng.below(450))); };
+
+    unsigned long failed = 0;
+    for (std::size_t i = 0; i < enemies; ++i) {
+        if (!scripts.start(stepScript, 0)) ++failed;
+        if (!startTimerScript()) ++failed;
+    }
+
+    std::vector<std::uint32_t> events;
+    unsigned long started = 0;
+    double updateNs = 0.0;
+    for (unsigned long frame = 0; frame < options.maxFrames; ++frame) {
+        game.waveTimeUs += static_cast<std::uint64_t>(std::lround(BENCH_STEP * 1.0e6f));
+        events.clear();
+        game.timers.advance(game.waveTimeUs * TIMER_TICKS_PER_SECOND / 1000000, events);
+        const auto updateStart = std::chrono::steady_clock::now();
+        scripts.update(game, assets, events);
+        updateNs += std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - updateStart).count();
+        while (scripts.running() < enemies * 2) { // Skończone skrypty timerów zastępują nowe
+            if (!startTimerScript()) {
+                ++failed;
+                break;
+            }
+            ++started;
+        }
+    }
+
+    // Każde ++score to jedno wznowienie (pierwsze wznowienia bez pracy są pomijane w liczniku)
+    const double resumes = std::max(1.0, static_cast<double>(game.score));
+    const double enemySteps = std::max(1.0, static_cast<double>(enemies) * 2 * options.maxFrames);
+    std::cout << std::fixed << std::setprecision(1)
+              << "Scripts: " << enemies << " step-driven + " << enemies << " timer-driven enemies for "
+              << options.maxFrames << " steps, " << started << " scripts restarted\n"
+              << "  resume: " << updateNs / resumes << " ns per resume, " << updateNs / enemySteps
+              << " ns per enemy per step (" << static_cast<unsigned long>(resumes) << " resumes)\n"
+              << "  frames: " << scripts.pool().largestFrame() << " bytes max of " << ScriptFramePool::FRAME_SIZE
+              << "-byte blocks, " << scripts.pool().used() << "/" << scripts.pool().capacity() << " in use, "
+              << failed << " failed creations\n";
+    return failed == 0 ? 0 : EXIT_FAILURE;
+}
@@ -0,0 +1,177 @@
+﻿#pragma once
+#include <coroutine>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <memory>
+#include <vector>
+
+struct Game;
+struct GameAssets;
+struct LaunchOptions;
+class EnemyScripts;
+
+// --- Pula ramek korutyn ---
+// Stała liczba bloków FRAME_SIZE bajtów z listą wolnych; pamięć bloków powstaje przy pierwszym
+// przydziale (gra bez skryptów, np. kopie do rollbacku, nic nie rezerwuje). Potem tworzenie i kończenie
+// skryptów nie dotyka sterty. Blok zaczyna się wskaźnikiem na pulę, żeby delete znalazło właściciela.
+class ScriptFramePool {
+public:
+    static const std::size_t FRAME_SIZE = 256; // Z nagłówkiem; większa ramka to błąd tworzenia skryptu
+
+    explicit ScriptFramePool(std::size_t capacity) : m_capacity(capacity) {}
+    ScriptFramePool(const ScriptFramePool&) = delete;
+    ScriptFramePool& operator=(const ScriptFramePool&) = delete;
+
+    // nullptr, gdy ramka się nie mieści albo pula jest pełna
+    void* allocate(std::size_t size) noexcept;
+    static void deallocate(void* frame) noexcept;
+
+    std::size_t capacity() const { return m_capacity; }
+    std::size_t used() const { return m_used; }
+    std::size_t largestFrame() const { return m_largestFrame; } // Największa żądana ramka (bez nagłówka)
+
+private:
+    union Block {
+        Block* nextFree;
+        alignas(std::max_align_t) unsigned char bytes[FRAME_SIZE];
+    };
+    static const std::size_t HEADER_SIZE = alignof(std::max_align_t); // Miejsce na wskaźnik puli
+
+    std::size_t m_capacity;
+    std::size_t m_used = 0;
+    std::size_t m_largestFrame = 0;
+    std::unique_ptr<Block[]> m_blocks;
+    Block* m_free = nullptr;
+};
+
+// Dostęp skryptu do gry; ważny tylko w trakcie wznowienia (EnemyScripts::update ustawia grę i zasoby)
+struct ScriptContext {
+    Game* game = nullptr;
+    const GameAssets* assets = nullptr;
+    EnemyScripts* scripts = nullptr;
+    std::uint32_t current = 0; // Slot wznawianego skryptu
+};
+
+// --- Skrypt zachowania wroga (korutyna C++20) ---
+// Funkcja zwracająca EnemyScript z co_await to skrypt: startuje zawieszony, a EnemyScripts wznawia go
+// w kroku symulacji. Pierwszy parametr to ScriptContext&, z którego operator new bierze pulę ramek.
+class EnemyScript {
+public:
+    struct promise_type {
+        template <typename... Args>
+        static void* operator new(std::size_t size, ScriptContext& context, Args&...) noexcept;
+        static void operator delete(void* frame) noexcept { ScriptFramePool::deallocate(frame); }
+
+        static EnemyScript get_return_object_on_allocation_failure() noexcept { return EnemyScript(); }
+        EnemyScript get_return_object() noexcept { return EnemyScript(std::coroutine_handle<promise_type>::from_promise(*this)); }
+        std::suspend_always initial_suspend() noexcept { return {}; }
+        std::suspend_always final_suspend() noexcept { return {}; }
+        void return_void() noexcept {}
+        void unhandled_exception() noexcept { std::terminate(); } // Gra nie używa wyjątków
+    };
+
+    EnemyScript() = default;
+    EnemyScript(EnemyScript&& other) noexcept : m_handle(other.m_handle) { other.m_handle = nullptr; }
+    EnemyScript& operator=(EnemyScript&& other) noexcept {
+        if (this != &other) {
+            reset();
+            m_handle = other.m_handle;
+            other.m_handle = nullptr;
+        }
+        return *this;
+    }
+    ~EnemyScript() { reset(); }
+
+    explicit operator bool() const { return static_cast<bool>(m_handle); }
+    bool done() const { return m_handle.done(); }
+    void resume() const { m_handle.resume(); }
+    void reset() {
+        if (m_handle) m_handle.destroy();
+        m_handle = nullptr;
+    }
+
+private:
+    explicit EnemyScript(std::coroutine_handle<promise_type> handle) : m_handle(handle) {}
+    std::coroutine_handle<promise_type> m_handle;
+};
+
+using EnemyScriptFunction = EnemyScript (*)(ScriptContext&, int);
+
+// --- Wykonawca skryptów jednej gry ---
+// Sloty skryptów z listą wolnych. Skrypt czeka albo na następny krok (nextStep), albo na timer koła
+// gry (wait): czekający na timer nie kosztuje nic, dopóki timer nie wygaśnie, więc tysiące wrogów
+// z długimi odliczaniami są darmowe między akcjami. Wznowienia idą w stałej kolejności (zdarzenia
+// koła, potem skrypty krokowe w kolejności zapisu), więc przebieg jest deterministyczny.
+// Timer budzi slot z generacją z chwili zaczekania; slot zwolniony lub zajęty od nowa ma inną
+// generację, więc stare zdarzenia koła (np. skopiowane razem z grą) nikogo nie budzą.
+class EnemyScripts {
+public:
+    static const std::size_t DEFAULT_CAPACITY = 4096;
+    static const std::size_t MAX_SLOTS = 1 << 16; // Slot i 8 bitów generacji w danych zdarzenia koła
+
+    EnemyScripts() : EnemyScripts(DEFAULT_CAPACITY) {}
+    explicit EnemyScripts(std::size_t capacity);
+    // Kopia gry (rollback) zaczyna bez skryptów, bo ramek korutyn nie da się kopiować: timery oryginału
+    // w kopii koła przestają pasować do slotów, a wrogowie prowadzeni co krok (nurkujący) dostają nowe
+    // skrypty przy pierwszym update (restartEnemyScripts). Skrypty z samymi odliczaniami (serie) przepadają.
+    EnemyScripts(const EnemyScripts& other);
+    EnemyScripts& operator=(const EnemyScripts& other);
+
+    // Nowy skrypt script(context, argument), pierwszy raz wznowiony w najbliższym update();
+    // false, gdy pula ramek jest pełna
+    template <typename Arg>
+    bool start(EnemyScript (*script)(ScriptContext&, Arg), Arg argument) { return adopt(script(m_context, argument)); }
+    // Wznawia skrypty obudzone zdarzeniami koła (ScriptWake) i czekające na krok
+    void update(Game& game, const GameAssets& assets, const std::vector<std::uint32_t>& timerEvents);
+    void clear();
+    // Przy następnym update najpierw restartEnemyScripts (stan gry odtworzony bez skryptów, np. migawka)
+    void requestRestart() { m_restartPending = true; }
+
+    std::size_t running() const { return m_running; }
+    const ScriptFramePool& pool() const { return m_pool; }
+    void* allocateFrame(std::size_t size) noexcept { return m_pool.allocate(size); } // Dla promise_type
+
+    // --- Oczekiwanie w skrypcie (co_await) ---
+    struct StepAwaiter {
+        ScriptContext& context;
+        bool await_ready() const noexcept { return false; }
+        void await_suspend(std::coroutine_handle<>) const { context.scripts->m_nextStep.push_back(context.current); }
+        void await_resume() const noexcept {}
+    };
+    struct TimerAwaiter {
+        ScriptContext& context;
+        float seconds;
+        bool await_ready() const noexcept { return false; }
+        void await_suspend(std::coroutine_handle<>) const { context.scripts->scheduleWake(context.current, seconds); }
+        void await_resume() const noexcept {}
+    };
+
+    static StepAwaiter nextStep(ScriptContext& context) { return StepAwaiter{context}; }
+    static TimerAwaiter wait(ScriptContext& context, float seconds) { return TimerAwaiter{context, seconds}; }
+
+private:
+    bool adopt(EnemyScript script);
+    void scheduleWake(std::uint32_t slot, float seconds);
+    void resumeSlot(std::uint32_t slot);
+    void releaseSlot(std::uint32_t slot);
+    void inheritGenerations(const EnemyScripts& other); // Generacje innego niż wszystkie sloty other
+
+    ScriptFramePool m_pool;
+    ScriptContext m_context;
+    std::vector<EnemyScript> m_slots;
+    std::vector<std::uint8_t> m_generations; // Po slocie, też za m_slots.size() (po clear)
+    std::vector<std::uint32_t> m_freeSlots;
+    std::vector<std::uint32_t> m_nextStep; // Wznawiane w następnym update (też nowe skrypty)
+    std::vector<std::uint32_t> m_resuming;
+    std::size_t m_running = 0;
+    bool m_restartPending = false;
+};
+
+template <typename... Args>
+void* EnemyScript::promise_type::operator new(std::size_t size, ScriptContext& context, Args&...) noexcept {
+    return context.scripts->allocateFrame(size);
+}
+
+// --bench-scripts N: N skryptów wznawianych co krok i N czekających na timery przez --frames kroków
+int runScriptBenchmark(const LaunchOptions& options);
@@ -0,0 +1,90 @@
+﻿#pragma once
+#include <SFML/Graphics.hpp>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+// --- Liczby stałoprzecinkowe 16.16 ---
+// Wartość to liczba całkowita w 1/65536 jednostki. Dodawanie i porównania to zwykłe operacje na int32,
+// mnożenie i dzielenie idą przez int64, więc wynik jest identyczny na każdym kompilatorze i procesorze
+// (bez zależności od FMA, precyzji rejestrów czy flag optymalizacji). Zakres: ±32768 z krokiem ~0.000015.
+class Fixed {
+public:
+    static const int FRACTION_BITS = 16;
+    static const std::int32_t ONE = std::int32_t(1) << FRACTION_BITS;
+
+    constexpr Fixed() : m_raw(0) {}
+    constexpr Fixed(int value) : m_raw(value * ONE) {}
+    // Zaokrąglenie do najbliższej wartości (stałe konfiguracji zamieniane raz, przy kompilacji)
+    constexpr Fixed(double value) : m_raw(static_cast<std::int32_t>(value * ONE + (value < 0 ? -0.5 : 0.5))) {}
+    constexpr Fixed(float value) : Fixed(static_cast<double>(value)) {}
+
+    static constexpr Fixed fromRaw(std::int32_t raw) { return Fixed(raw, RawTag{}); }
+    constexpr std::int32_t raw() const { return m_raw; }
+
+    // Tylko jawnie (rysowanie, zapis): obliczenia symulacji nie wracają do float
+    explicit constexpr operator float() const { return static_cast<float>(m_raw) / ONE; }
+
+    constexpr Fixed operator-() const { return fromRaw(-m_raw); }
+    Fixed& operator+=(Fixed other) { m_raw += other.m_raw; return *this; }
+    Fixed& operator-=(Fixed other) { m_raw -= other.m_raw; return *this; }
+    Fixed& operator*=(Fixed other) { return *this = *this * other; }
+    Fixed& operator/=(Fixed other) { return *this = *this / other; }
+
+    friend constexpr Fixed operator+(Fixed a, Fixed b) { return fromRaw(a.m_raw + b.m_raw); }
+    friend constexpr Fixed operator-(Fixed a, Fixed b) { return fromRaw(a.m_raw - b.m_raw); }
+    friend constexpr Fixed operator*(Fixed a, Fixed b) {
+        return fromRaw(static_cast<std::int32_t>((static_cast<std::int64_t>(a.m_raw) * b.m_raw) >> FRACTION_BITS));
+    }
+    // Wynik poza zakresem (też dzielenie przez zero) jest nasycany do największej wartości z tym znakiem
+    friend constexpr Fixed operator/(Fixed a, Fixed b) {
+        return b.m_raw == 0 ? fromRaw(a.m_raw < 0 ? INT32_MIN : INT32_MAX)
+                            : fromRaw(saturate((static_cast<std::int64_t>(a.m_raw) * ONE) / b.m_raw));
+    }
+
+    friend constexpr bool operator==(Fixed a, Fixed b) { return a.m_raw == b.m_raw; }
+    friend constexpr bool operator!=(Fixed a, Fixed b) { return a.m_raw != b.m_raw; }
+    friend constexpr bool operator<(Fixed a, Fixed b) { return a.m_raw < b.m_raw; }
+    friend constexpr bool operator>(Fixed a, Fixed b) { return a.m_raw > b.m_raw; }
+    friend constexpr bool operator<=(Fixed a, Fixed b) { return a.m_raw <= b.m_raw; }
+    friend constexpr bool operator>=(Fixed a, Fixed b) { return a.m_raw >= b.m_raw; }
+
+private:
+    struct RawTag {};
+    constexpr Fixed(std::int32_t raw, RawTag) : m_raw(raw) {}
+
+    static constexpr std::int32_t saturate(std::int64_t value) {
+        return value > INT32_MAX ? INT32_MAX : value < INT32_MIN ? INT32_MIN : static_cast<std::int32_t>(value);
+    }
+
+    std::int32_t m_raw;
+};
+
+// --- Typ liczb symulacji ---
+// Pozycje, prędkości, rozmiary i kolizje liczą się w Scalar: domyślnie float, a przy GALAXY_FIXED_POINT
+// (opcja CMake) w Fixed, co daje symulację identyczną bit w bit na różnych maszynach (powtórki, lockstep).
+// Rysowanie i zapis dostają float przez jawną konwersję (sf::Vector2f(v), sf::FloatRect(r)).
+#ifdef GALAXY_FIXED_POINT
+using Scalar = Fixed;
+#else
+using Scalar = float;
+#endif
+using Vec2 = sf::Vector2<Scalar>;
+using Rect = sf::Rect<Scalar>;
+
+inline Scalar scalarAbs(Scalar value) { return value < Scalar(0) ? -value : value; }
+
+inline int roundToInt(float value) { return static_cast<int>(std::lround(value)); }
+inline int ceilToInt(float value) { return static_cast<int>(std::ceil(value)); }
+inline int floorToInt(float value) { return static_cast<int>(std::floor(value)); }
+inline int roundToInt(Fixed value) { return (value.raw() + Fixed::ONE / 2) >> Fixed::FRACTION_BITS; }
+inline int ceilToInt(Fixed value) { return (value.raw() + Fixed::ONE - 1) >> Fixed::FRACTION_BITS; }
+inline int floorToInt(Fixed value) { return value.raw() >> Fixed::FRACTION_BITS; }
+
+// Bity wartości (sumy kontrolne stanu gry)
+inline std::uint32_t scalarBits(float value) {
+    std::uint32_t bits;
+    std::memcpy(&bits, &value, sizeof bits);
+    return bits;
+}
+inline std::uint32_t scalarBits(Fixed value) { return static_cast<std::uint32_t>(value.raw()); }
@@ -0,0 +1,94 @@
+﻿#include "frame_pacer.h"
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <string>
+#include <thread>
+#include "trace.h"
+
+namespace {
+const double MIN_MARGIN_US = 100.0;
+const double MAX_MARGIN_US = 4000.0;
+const double MARGIN_SMOOTHING = 0.05; // Waga nowej próbki w średnich kroczących
+
+double toMicroseconds(std::chrono::steady_clock::duration d) {
+    return std::chrono::duration<double, std::micro>(d).count();
+}
+} // namespace
+
+FramePacer::FramePacer(unsigned int targetHz) {
+    setTarget(targetHz);
+}
+
+void FramePacer::setTarget(unsigned int targetHz) {
+    m_targetHz = targetHz;
+    m_period = targetHz > 0
+        ? std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(1.0 / targetHz))
+        : Clock::duration::zero();
+    m_started = false; // Nowy okres: terminy liczone od następnej klatki
+}
+
+void FramePacer::wait() {
+    TRACE_SCOPE("pace wait");
+    // Odstęp od poprzedniej klatki liczy się do jittera tylko w ciągłym rytmie: nie po zmianie okresu
+    // (setTarget) i nie po przestoju, po którym terminy zaczynają się od nowa
+    bool measured = m_targetHz > 0 && m_started;
+    if (m_targetHz > 0) {
+        Clock::time_point now = Clock::now();
+        if (!m_started) {
+            m_deadline = now;
+            m_started = true;
+        }
+        m_deadline += m_period;
+        // Po dużym przestoju (np. ładowanie) nie nadrabiamy klatek seriami, tylko zaczynamy od teraz
+        if (now - m_deadline > m_period) {
+            m_deadline = now + m_period;
+            measured = false;
+        }
+
+        const Clock::time_point wakeUp = m_deadline - std::chrono::microseconds(static_cast<long long>(m_marginUs));
+        if (wakeUp > now) {
+            std::this_thread::sleep_for(wakeUp - now);
+            adaptMargin(toMicroseconds(Clock::now() - wakeUp));
+        }
+        while (Clock::now() < m_deadline) {
+            // Aktywne czekanie na ostatnie mikrosekundy
+        }
+    }
+
+    const Clock::time_point frameEnd = Clock::now();
+    if (measured) {
+        const double jitter = std::abs(toMicroseconds(frameEnd - m_lastFrame) - toMicroseconds(m_period));
+        m_jitterSumUs += jitter;
+        m_jitterMaxUs = std::max(m_jitterMaxUs, jitter);
+        ++m_jitterSamples;
+    }
+    m_lastFrame = frameEnd;
+    ++m_frames;
+}
+
+void FramePacer::adaptMargin(double oversleepUs) {
+    // Margines = średnie zaspanie + 3 odchylenia, żeby rzadko budzić się po terminie
+    const double deviation = std::abs(oversleepUs - m_oversleepAvgUs);
+    m_oversleepAvgUs += MARGIN_SMOOTHING * (oversleepUs - m_oversleepAvgUs);
+    m_oversleepDevUs += MARGIN_SMOOTHING * (deviation - m_oversleepDevUs);
+    m_marginUs = std::min(MAX_MARGIN_US, std::max(MIN_MARGIN_US, m_oversleepAvgUs + 3.0 * m_oversleepDevUs));
+}
+
+FramePacer::Stats FramePacer::stats() const {
+    Stats s;
+    s.frames = m_frames;
+    s.meanJitterMs = m_jitterSamples > 0 ? m_jitterSumUs / m_jitterSamples / 1000.0 : 0.0;
+    s.maxJitterMs = m_jitterMaxUs / 1000.0;
+    s.sleepMarginMs = m_marginUs / 1000.0;
+    return s;
+}
+
+void FramePacer::writeStats(std::ostream& out) const {
+    const Stats s = stats();
+    out << std::fixed << std::setprecision(3)
+        << "Frame pacing: " << s.frames << " frames at "
+        << (m_targetHz > 0 ? std::to_string(m_targetHz) + " Hz" : std::string("uncapped"))
+        << ", jitter mean " << s.meanJitterMs << " ms, max " << s.maxJitterMs
+        << " ms, sleep margin " << s.sleepMarginMs << " ms\n";
+}
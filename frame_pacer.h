@@ -0,0 +1,48 @@
+﻿#pragma once
+#include <chrono>
+#include <ostream>
+
+// --- Regulator tempa klatek ---
+// Zastępuje window.setFramerateLimit: śpi do (termin - margines), a resztę dobija aktywnym
+// czekaniem, bo sf::sleep/sleep_for na Linuksie potrafi zaspać o milisekundę i więcej.
+// Margines dopasowuje się do zmierzonego zaspania, więc pętla kręci się tylko tyle, ile trzeba.
+class FramePacer {
+public:
+    struct Stats {
+        unsigned long frames;
+        double meanJitterMs;  // Średnie |odstęp klatek - okres|
+        double maxJitterMs;
+        double sleepMarginMs; // Aktualny margines spania przed aktywnym czekaniem
+    };
+
+    explicit FramePacer(unsigned int targetHz); // 0: bez limitu
+
+    void setTarget(unsigned int targetHz);
+    unsigned int target() const { return m_targetHz; }
+
+    // Wywoływać raz na klatkę, po window.display()
+    void wait();
+
+    Stats stats() const;
+    void writeStats(std::ostream& out) const;
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    void adaptMargin(double oversleepUs);
+
+    unsigned int m_targetHz;
+    Clock::duration m_period;
+    Clock::time_point m_deadline;
+    Clock::time_point m_lastFrame;
+    bool m_started = false;
+
+    double m_marginUs = 1000.0;  // Początkowo 1 ms, potem z pomiarów
+    double m_oversleepAvgUs = 0.0;
+    double m_oversleepDevUs = 0.0;
+
+    unsigned long m_frames = 0;
+    unsigned long m_jitterSamples = 0; // Klatki z odstępem w ciągłym rytmie (bez pierwszej po zmianie i przestoju)
+    double m_jitterSumUs = 0.0;
+    double m_jitterMaxUs = 0.0;
+};
@@ -0,0 +1,837 @@
+﻿#include "game.h"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include "job_system.h"
+#include "swept_collision.h"
+#include "task_graph.h"
+#include "trace.h"
+
+namespace {
+sf::Vector2f scaledSize(const sf::Image& image, float scaleFactor) {
+    return sf::Vector2f(image.getSize().x * scaleFactor, image.getSize().y * scaleFactor);
+}
+
+// Rozmiar maski kolizji dla obiektu o danym rozmiarze na ekranie
+sf::Vector2u maskSize(sf::Vector2f size) {
+    return sf::Vector2u(static_cast<unsigned int>(std::ceil(size.x)), static_cast<unsigned int>(std::ceil(size.y)));
+}
+
+Vec2 centerOf(const Rect& bounds) {
+    return Vec2(bounds.left + bounds.width / Scalar(2), bounds.top + bounds.height / Scalar(2));
+}
+
+// Prostokąt całkowicie poza ekranem. Pociski i cząsteczki lecą po prostej, a odcinek, który opuścił
+// wypukły prostokąt, już do niego nie wraca, więc taki obiekt można usunąć od razu.
+template <typename Config>
+bool outsideScreen(const Rect& bounds) {
+    return bounds.left + bounds.width <= Scalar(0) || bounds.left >= Scalar(Config::SCREEN_WIDTH) ||
+           bounds.top + bounds.height <= Scalar(0) || bounds.top >= Scalar(Config::SCREEN_HEIGHT);
+}
+
+// Unikalne w procesie numery generacji formacji (wspólny licznik dla wszystkich instancji gry)
+std::atomic<std::uint64_t> nextFormationGeneration{1};
+
+// --- Losowość eksplozji ---
+// Wszystkie liczby dla eksplozji są losowane jednym wywołaniem fillUnit przed pętlą spawnów
+const std::size_t RANDOMS_PER_PARTICLE = 7; // Promień, 3 składowe koloru, prędkość x/y, czas życia
+const int ENEMY_EXPLOSION_PARTICLES = 25;   // Fewer particles than player explosion
+const int PLAYER_EXPLOSION_PARTICLES = 40;
+
+// Liczba z [lo, hi] z jednostajnego u z [0, 1)
+int unitToInt(float u, int lo, int hi) {
+    return lo + static_cast<int>(u * (hi - lo + 1));
+}
+
+float unitToRange(float u, float lo, float hi) {
+    return lo + (hi - lo) * u;
+}
+
+// --- Funkcja tworzenia eksplozji wroga ---
+void createEnemyExplosion(Game& game, Vec2 position) {
+    std::array<float, ENEMY_EXPLOSION_PARTICLES * RANDOMS_PER_PARTICLE> randoms;
+    game.random.stream(RandomStream::Particles).fillUnit(randoms.data(), randoms.size());
+
+    for (int i = 0; i < ENEMY_EXPLOSION_PARTICLES; ++i) {
+        const float* u = &randoms[i * RANDOMS_PER_PARTICLE];
+        Renderable look;
+        look.radius = static_cast<float>(unitToInt(u[0], 1, 2)); // Smaller particles
+        // Example: Greenish/Grayish color
+        look.color = sf::Color(unitToInt(u[1], 50, 150) / 2, unitToInt(u[2], 50, 150), unitToInt(u[3], 50, 150) / 2, 200);
+        const Vec2 velocity(unitToRange(u[4], -60.0f, 60.0f), unitToRange(u[5], -60.0f, 60.0f)); // Slightly slower particles
+        game.commands.spawn(Transform{position}, Velocity{velocity}, look, Lifetime{unitToRange(u[6], 0.3f, 0.8f)}); // Shorter lifetime
+    }
+}
+
+// --- Funkcja tworzenia eksplozji ---
+void createPlayerExplosion(Game& game, Vec2 position) {
+    std::array<float, PLAYER_EXPLOSION_PARTICLES * RANDOMS_PER_PARTICLE> randoms;
+    game.random.stream(RandomStream::Particles).fillUnit(randoms.data(), randoms.size());
+
+    for (int i = 0; i < PLAYER_EXPLOSION_PARTICLES; ++i) {
+        const float* u = &randoms[i * RANDOMS_PER_PARTICLE];
+        Renderable look;
+        look.radius = static_cast<float>(unitToInt(u[0], 1, 3));
+        look.color = sf::Color(unitToInt(u[1], 100, 255), unitToInt(u[2], 100, 255) / 2, 0, 220); // u[3] bez użycia
+        const Vec2 velocity(unitToRange(u[4], -90.0f, 90.0f), unitToRange(u[5], -90.0f, 90.0f));
+        game.commands.spawn(Transform{position}, Velocity{velocity}, look, Lifetime{unitToRange(u[6], 0.4f, 1.2f)});
+    }
+}
+
+// Wspólna obsługa śmierci gracza (pocisk, zderzenie, wrogowie na dole)
+void killPlayer(Game& game) {
+    game.state = GameState::GameOver;
+    createPlayerExplosion(game, centerOf(worldBounds(game.world.get<Transform>(game.player), game.world.get<Bounds>(game.player))));
+    game.world.get<Renderable>(game.player).color = sf::Color::Transparent;
+}
+
+template <typename Config>
+Vec2 formationStartFor(Vec2 enemySize) {
+    const Scalar enemySpacingX = enemySize.x * Scalar(Config::FORMATION_SPACING);
+    return Vec2((Scalar(Config::SCREEN_WIDTH) - Scalar(Config::FORMATION_COLUMNS - 1) * enemySpacingX - enemySize.x) / Scalar(2),
+                Scalar(Config::FORMATION_TOP));
+}
+
+// Gracz na starcie i pełna formacja wrogów; reszta świata jest czyszczona
+template <typename Config>
+void spawnWave(Game& game, const GameAssets& assets) {
+    game.world.clear(); // Pociski, wrogowie, cząsteczki i poprzedni gracz
+    game.commands.clear();
+
+    const Vec2 playerSize = assets.playerSize;
+    const Vec2 enemySize = assets.enemySize;
+    game.player = game.world.spawn(
+        Transform{Vec2(Scalar(Config::SCREEN_WIDTH / 2.0f) - playerSize.x / Scalar(2), Scalar(Config::SCREEN_HEIGHT) - playerSize.y - Scalar(10))},
+        Bounds{playerSize},
+        Renderable{TextureId::Player},
+        Team::Player);
+    game.lastPlayerPosition = game.world.get<Transform>(game.player).position;
+
+    // Pełna formacja wrogów na starcie
+    game.formation.reset(Config::FORMATION_COLUMNS, Config::FORMATION_ROWS, formationStartFor<Config>(enemySize),
+                         enemySize * Scalar(Config::FORMATION_SPACING), enemySize);
+    game.enemyDirection = 1.0f; // Reset kierunku wrogów
+    game.moveEnemiesDown = false;
+    game.scripts.clear(); // Przed kołem: skrypty czekają na jego timery
+    game.divers = 0;
+    game.timers.clear();
+    game.waveTimeUs = 0;
+    game.enemyShotTimer = game.versus ? TimerWheel::Handle() : game.timers.schedule(
+        secondsToTicks(Config::ENEMY_SHOOT_INTERVAL), static_cast<std::uint32_t>(TimerEvent::EnemyShot));
+    game.state = GameState::Playing;
+}
+
+// --- Przechwytywanie pocisków ---
+using SweepList = std::vector<BulletSweep::Entry>;
+
+// Zakres x toru pocisku w kroku (pozycja jest już po ruchu o step)
+void setSweepRange(BulletSweep::Entry& entry, const Rect& bounds, Scalar stepX) {
+    entry.left = bounds.left - std::max(stepX, Scalar(0));
+    entry.right = bounds.left + bounds.width - std::min(stepX, Scalar(0));
+}
+
+// Wpisy z poprzedniego kroku: bez usuniętych pocisków i tych, które właśnie opuściły ekran
+template <typename Config>
+void refreshSweepList(SweepList& list, World& world, Scalar deltaTime) {
+    std::size_t kept = 0;
+    for (BulletSweep::Entry& entry : list) {
+        if (!world.isAlive(entry.bullet)) continue;
+        const Rect bounds = worldBounds(world.get<Transform>(entry.bullet), world.get<Bounds>(entry.bullet));
+        if (outsideScreen<Config>(bounds)) continue;
+        setSweepRange(entry, bounds, world.get<Velocity>(entry.bullet).value.x * deltaTime);
+        entry.intercepted = false;
+        list[kept++] = entry;
+    }
+    list.resize(kept);
+}
+
+// Prawie posortowana lista: każdy wpis przesuwa się o tyle pozycji, o ile wyprzedził sąsiadów
+void insertionSortByLeft(SweepList& list) {
+    for (std::size_t i = 1; i < list.size(); ++i) {
+        const BulletSweep::Entry entry = list[i];
+        std::size_t j = i;
+        for (; j > 0 && list[j - 1].left > entry.left; --j) list[j] = list[j - 1];
+        list[j] = entry;
+    }
+}
+
+bool bulletsMeet(World& world, const GameAssets& assets, Entity a, Entity b, Scalar deltaTime) {
+    return firstContact(assets.maskFor(world.get<Renderable>(a).texture),
+                        worldBounds(world.get<Transform>(a), world.get<Bounds>(a)), world.get<Velocity>(a).value * deltaTime,
+                        assets.maskFor(world.get<Renderable>(b).texture),
+                        worldBounds(world.get<Transform>(b), world.get<Bounds>(b)), world.get<Velocity>(b).value * deltaTime) >= Scalar(0);
+}
+
+// Wpis z jednej listy wchodzi pod miotłę: aktywne wpisy drugiej listy, które kończą się przed nim,
+// odpadają na stałe (kolejne wpisy zaczynają się jeszcze dalej), reszta to kandydaci do zderzenia
+bool sweepEntry(BulletSweep::Entry& entry, SweepList& others, std::vector<std::uint32_t>& othersActive,
+                World& world, const GameAssets& assets, Scalar deltaTime) {
+    std::size_t kept = 0;
+    bool hit = false;
+    for (std::uint32_t index : othersActive) {
+        BulletSweep::Entry& other = others[index];
+        if (other.intercepted || other.right < entry.left) continue;
+        if (!hit && bulletsMeet(world, assets, entry.bullet, other.bullet, deltaTime)) {
+            entry.intercepted = other.intercepted = true;
+            hit = true;
+            continue;
+        }
+        othersActive[kept++] = index;
+    }
+    othersActive.resize(kept);
+    return hit;
+}
+
+// Pociski gracza i wrogów, które zderzyły się w tym kroku, znikają parami (każdy pocisk raz)
+template <typename Config>
+void interceptBullets(Game& game, const GameAssets& assets, Scalar deltaTime) {
+    World& world = game.world;
+    BulletSweep& sweep = game.bulletSweep;
+    refreshSweepList<Config>(sweep.player, world, deltaTime);
+    refreshSweepList<Config>(sweep.enemy, world, deltaTime);
+
+    // Nowe pociski (spawny z poprzedniego kroku) na koniec list
+    world.each<Transform, Velocity, Bounds, Team>([&](Entity e, Transform& transform, Velocity& velocity, Bounds& bounds, Team& team) {
+        if (e.index >= sweep.listed.size()) sweep.listed.resize(e.index + 1, 0);
+        if (sweep.listed[e.index] == e.generation + 1) return;
+        const Rect bulletBounds = worldBounds(transform, bounds);
+        if (outsideScreen<Config>(bulletBounds)) return;
+        sweep.listed[e.index] = e.generation + 1;
+        BulletSweep::Entry entry{Scalar(0), Scalar(0), e, false};
+        setSweepRange(entry, bulletBounds, velocity.value.x * deltaTime);
+        (team == Team::Player ? sweep.player : sweep.enemy).push_back(entry);
+    });
+    insertionSortByLeft(sweep.player);
+    insertionSortByLeft(sweep.enemy);
+    if (sweep.player.empty() || sweep.enemy.empty()) return;
+
+    // Miotła po x przez obie listy naraz; wpis jest porównywany tylko z aktywnymi wpisami drugiej listy
+    sweep.activePlayer.clear();
+    sweep.activeEnemy.clear();
+    std::size_t p = 0;
+    std::size_t q = 0;
+    bool anyHit = false;
+    while (p < sweep.player.size() || q < sweep.enemy.size()) {
+        if (q == sweep.enemy.size() || (p < sweep.player.size() && sweep.player[p].left <= sweep.enemy[q].left)) {
+            if (sweepEntry(sweep.player[p], sweep.enemy, sweep.activeEnemy, world, assets, deltaTime)) anyHit = true;
+            else sweep.activePlayer.push_back(static_cast<std::uint32_t>(p));
+            ++p;
+        } else {
+            if (sweepEntry(sweep.enemy[q], sweep.player, sweep.activePlayer, world, assets, deltaTime)) anyHit = true;
+            else sweep.activeEnemy.push_back(static_cast<std::uint32_t>(q));
+            ++q;
+        }
+    }
+    if (!anyHit) return;
+
+    // Poza iteracją po świecie, więc usunięcie od razu: dalsze systemy kroku już tych pocisków nie widzą.
+    // Wpisy znikną z list przy następnym kroku (isAlive).
+    for (const SweepList* list : {&sweep.player, &sweep.enemy}) {
+        for (const BulletSweep::Entry& entry : *list) {
+            if (entry.intercepted) world.despawn(entry.bullet);
+        }
+    }
+}
+
+// --- Skrypty wrogów ---
+// Korutyny uruchamiane przez strzał wroga (Config::ENEMY_SCRIPTS) z komórką strzelca jako argumentem.
+// Wznawia je faza "enemy scripts" kroku, więc widzą formację i pociski już po ruchu w tym kroku.
+const int BURST_SHOTS = 3;
+const float BURST_INTERVAL = 0.12f;
+const int STRAFE_SHOTS = 5;
+const float STRAFE_INTERVAL = 0.08f;
+const float STRAFE_SPREAD = 0.4f;    // Skrajne pociski wachlarza: prędkość pozioma / ENEMY_BULLET_SPEED
+const float DIVE_SPEED = 160.0f;     // Prędkość nurkowania w dół
+const float DIVE_STEER = 2.0f;       // Prędkość pozioma na piksel odległości od gracza (1/s)
+const float DIVE_MAX_SIDE = 120.0f;
+
+// Seria kilku strzałów prosto w dół
+EnemyScript burstFire(ScriptContext& ctx, int cell) {
+    Game& game = *ctx.game;
+    for (int shot = 0; shot < BURST_SHOTS; ++shot) {
+        if (shot > 0) co_await EnemyScripts::wait(ctx, BURST_INTERVAL);
+        if (!game.formation.isAlive(cell)) co_return;
+        fireEnemyBullet(game, *ctx.assets, game.formation.cellBounds(cell));
+    }
+}
+
+// Wachlarz pocisków omiatający dół ekranu od strony, w którą idzie formacja
+EnemyScript strafe(ScriptContext& ctx, int cell) {
+    Game& game = *ctx.game;
+    const float side = game.enemyDirection > 0 ? -1.0f : 1.0f;
+    for (int shot = 0; shot < STRAFE_SHOTS; ++shot) {
+        if (shot > 0) co_await EnemyScripts::wait(ctx, STRAFE_INTERVAL);
+        if (!game.formation.isAlive(cell)) co_return;
+        const float sweep = side * (1.0f - 2.0f * shot / (STRAFE_SHOTS - 1)); // Od side do -side
+        fireEnemyBullet(game, *ctx.assets, game.formation.cellBounds(cell),
+                        Vec2(Scalar(sweep * STRAFE_SPREAD * ENEMY_BULLET_SPEED), Scalar(ENEMY_BULLET_SPEED)));
+    }
+}
+
+// Nurkujący to encja z drużyny wrogów z teksturą wroga, więc ruch, zderzenie z graczem i zestrzelenie
+// (przechwytywanie) obsługują zwykłe systemy pocisków. Skrypt co krok koryguje kurs, a gdy encja
+// zniknie jeszcze na ekranie (bounds z poprzedniego kroku), to została zestrzelona. Do końca skryptu
+// nurkujący liczy się w game.divers, więc fala nie kończy się przed punktami za niego.
+
+// Krok nurkującego; false, gdy już nie żyje (skrypt się kończy)
+bool followDiver(Game& game, Entity diver, Rect& bounds) {
+    if (!game.world.isAlive(diver)) {
+        if (!outsideScreen<ActiveConfig>(bounds)) {
+            createEnemyExplosion(game, centerOf(bounds));
+            game.score += 10;
+        }
+        --game.divers;
+        return false;
+    }
+    bounds = worldBounds(game.world.get<Transform>(diver), game.world.get<Bounds>(diver));
+    const Rect target = worldBounds(game.world.get<Transform>(game.player), game.world.get<Bounds>(game.player));
+    const Scalar toPlayer = centerOf(target).x - centerOf(bounds).x;
+    const Scalar side = std::max(Scalar(-DIVE_MAX_SIDE), std::min(Scalar(DIVE_MAX_SIDE), toPlayer * Scalar(DIVE_STEER)));
+    game.world.get<Velocity>(diver).value = Vec2(side, Scalar(DIVE_SPEED));
+    return true;
+}
+
+// Wróg opuszcza formację i nurkuje w stronę gracza
+EnemyScript dive(ScriptContext& ctx, int cell) {
+    Game& game = *ctx.game;
+    if (!game.formation.isAlive(cell)) co_return;
+    Rect bounds = game.formation.cellBounds(cell);
+    game.formation.kill(cell);
+    const Entity diver = game.world.spawn(Transform{Vec2(bounds.left, bounds.top)}, Velocity{Vec2(0, Scalar(DIVE_SPEED))},
+                                          Bounds{ctx.assets->enemySize}, Renderable{TextureId::Enemy}, Team::Enemy);
+    ++game.divers;
+    do {
+        co_await EnemyScripts::nextStep(ctx);
+    } while (followDiver(game, diver, bounds));
+}
+
+// Nurkujący bez skryptu (migawka, kopia gry) przejmowany w kroku, w którym prowadziłby go poprzedni skrypt
+EnemyScript steerDiver(ScriptContext& ctx, Entity diver) {
+    Game& game = *ctx.game;
+    Rect bounds;
+    while (followDiver(game, diver, bounds)) co_await EnemyScripts::nextStep(ctx);
+}
+
+// Nurkowanie rzadziej niż strzały: 1/4 nurkowanie, 1/4 wachlarz, 1/2 seria
+EnemyScriptFunction pickEnemyScript(Game& game) {
+    switch (game.random.stream(RandomStream::Shooter).below(4)) {
+        case 0: return dive;
+        case 1: return strafe;
+        default: return burstFire;
+    }
+}
+
+// --- Krok jako graf zadań ---
+// Dane, które fazy kroku czytają i zapisują (zasoby TaskGraph)
+const std::uint32_t STEP_BULLETS = 1u << 0;    // Pozycje pocisków i ich usuwanie przez przechwytywanie
+const std::uint32_t STEP_FORMATION = 1u << 1;  // Formacja, kierunek i krok wrogów
+const std::uint32_t STEP_PLAYER = 1u << 2;     // Gracz i to, czy faza Playing trwa dalej w tym kroku
+const std::uint32_t STEP_EFFECTS = 1u << 3;    // game.commands, wynik, odliczanie strzału, strumienie losowe
+const std::uint32_t STEP_CANDIDATES = 1u << 4; // scratch.bullets i prostokąt gracza
+const std::uint32_t STEP_PARTICLES = 1u << 5;
+const std::uint32_t STEP_WORLD = 1u << 6;      // Natychmiastowe spawny w świecie (skrypty wrogów)
+
+// Porcje dużych pętli (stałe, żeby podział nie zależał od liczby wątków)
+const std::size_t BULLET_CHUNK = 256;
+const std::size_t COLLISION_CHUNK = 64;
+const std::size_t PARTICLE_CHUNK = 512;
+
+struct StepContext {
+    Game& game;
+    const GameAssets& assets;
+    JobSystem* jobs;
+    float deltaTime;
+    Scalar dt;      // Krok dla geometrii; odliczania czasu zostają w float
+    // Faza Playing na początku kroku: czytają ją fazy, które mogą iść równolegle z końcem gry
+    // (ruch pocisków obok ruchu formacji), więc nie zależą od tego, który wątek skończy pierwszy
+    const bool startedPlaying;
+    bool playing;   // Faza Playing trwa (śmierć gracza kończy ją w połowie kroku); tylko fazy zależne od STEP_PLAYER
+    Vec2 enemyStep; // Przesunięcie formacji w tym kroku
+    Rect playerBounds;
+    Vec2 playerStep;
+    const CollisionMask* playerMask;
+};
+
+// Najwcześniej trafiona żywa komórka z zakresu [c0, c1] x [r0, r1] albo -1 (remis: pierwsza w kolejności komórek)
+int earliestHitCell(const StepContext& ctx, const Rect& bulletBounds, Vec2 bulletStep, const CollisionMask& bulletMask,
+                    int c0, int c1, int r0, int r1) {
+    const Formation& formation = ctx.game.formation;
+    const CollisionMask& enemyMask = ctx.assets.maskFor(TextureId::Enemy);
+    int target = -1;
+    Scalar earliestHit = 2;
+    for (int row = r0; row <= r1; ++row) {
+        for (int column = c0; column <= c1; ++column) {
+            const int cell = row * formation.columns + column;
+            if (!formation.isAlive(cell)) continue;
+            const Scalar t = firstContact(bulletMask, bulletBounds, bulletStep, enemyMask, formation.cellBounds(cell), ctx.enemyStep);
+            if (t >= Scalar(0) && t < earliestHit) {
+                earliestHit = t;
+                target = cell;
+            }
+        }
+    }
+    return target;
+}
+
+// Ruch Pocisków (gracza i wrogów) i usuwanie tych, które opuściły ekran
+template <typename Config>
+void moveBullets(StepContext& ctx) {
+    if (!ctx.startedPlaying) return;
+    World& world = ctx.game.world;
+    std::vector<CommandBuffer>& buffers = ctx.game.scratch.bulletCommands;
+    const std::size_t count = world.count<Transform, Velocity, Bounds>();
+    buffers.resize(chunkCount(count, BULLET_CHUNK));
+    parallelFor(ctx.jobs, count, BULLET_CHUNK, [&](std::size_t chunk, std::size_t begin, std::size_t end) {
+        CommandBuffer& commands = buffers[chunk];
+        world.eachInRange<Transform, Velocity, Bounds>(begin, end, [&](Entity e, Transform& transform, Velocity& velocity, Bounds& bounds) {
+            transform.position += velocity.value * ctx.dt;
+            if (outsideScreen<Config>(worldBounds(transform, bounds))) commands.despawn(e);
+        });
+    });
+}
+
+// Ruch Wrogów i Sprawdzanie Krawędzi/Dna (prostokąt żywych wrogów zamiast pętli po wrogach)
+template <typename Config>
+void moveFormation(StepContext& ctx) {
+    if (!ctx.playing) return;
+    Game& game = ctx.game;
+    Formation& formation = game.formation;
+    game.moveEnemiesDown = false;
+    const Rect enemyBounds = formation.aliveBounds();
+    if (formation.aliveCount > 0) {
+        // Sprawdzenie krawędzi
+        if ((game.enemyDirection > 0 && enemyBounds.left + enemyBounds.width >= Scalar(Config::SCREEN_WIDTH - 5.f)) ||
+            (game.enemyDirection < 0 && enemyBounds.left <= Scalar(5))) {
+            game.enemyDirection *= -1.0f;
+            game.moveEnemiesDown = true;
+        } else if (enemyBounds.top + enemyBounds.height >= Scalar(Config::SCREEN_HEIGHT - 50.f)) { // Wróg blisko samego dołu (Game Over)
+            killPlayer(game);
+            ctx.playing = false;
+            return;
+        }
+    }
+    // Cała formacja przesuwa się jednym wektorem
+    ctx.enemyStep = Vec2(Scalar(Config::ENEMY_SPEED * game.enemyDirection) * ctx.dt, Scalar(game.moveEnemiesDown ? Config::ENEMY_DROP_DISTANCE : 0.f));
+    formation.origin += ctx.enemyStep;
+}
+
+// Strzelanie Wrogów (w trybie versus strzela drugi gracz przez stepVersus)
+template <typename Config>
+void enemyShooting(StepContext& ctx) {
+    if (!ctx.playing) return;
+    Game& game = ctx.game;
+    const Formation& formation = game.formation;
+    for (std::uint32_t event : game.scratch.timerEvents) {
+        if (timerEventKind(event) != TimerEvent::EnemyShot) continue;
+        if (formation.aliveCount > 0) {
+            // Strzelec to n-ty żywy wróg w kolejności komórek
+            std::uint32_t skip = game.random.stream(RandomStream::Shooter).below(static_cast<std::uint32_t>(formation.aliveCount));
+            int shooter = 0;
+            for (;; ++shooter) {
+                if (formation.isAlive(shooter) && skip-- == 0) break;
+            }
+            // Pełna pula skryptów: zwykły strzał
+            if (!Config::ENEMY_SCRIPTS || !game.scripts.start(pickEnemyScript(game), shooter)) {
+                fireEnemyBullet(game, ctx.assets, formation.cellBounds(shooter));
+            }
+        }
+        game.enemyShotTimer = game.timers.schedule(secondsToTicks(Config::ENEMY_SHOOT_INTERVAL), event);
+    }
+}
+
+// Skrypty wrogów obudzone w tym kroku (timery) i sterowane co krok; działają po ruchu pocisków
+// i formacji, a przed przechwytywaniem i kolizjami, które już widzą ich pociski i nurkujących
+void runEnemyScripts(StepContext& ctx) {
+    if (ctx.playing) ctx.game.scripts.update(ctx.game, ctx.assets, ctx.game.scratch.timerEvents);
+}
+
+template <typename Config>
+void interceptStep(StepContext& ctx) {
+    if (Config::BULLET_INTERCEPTION && ctx.playing) interceptBullets<Config>(ctx.game, ctx.assets, ctx.dt);
+}
+
+// Faza wstępna kolizji: dla pocisku gracza komórki pod jego torem w układzie formacji (ruch względem
+// formacji), dla pocisku wroga tylko wpis; pocisk wroga sprawdza się od razu z prostokątem gracza
+void collisionBroadPhase(StepContext& ctx) {
+    if (!ctx.playing) return;
+    World& world = ctx.game.world;
+    const Formation& formation = ctx.game.formation;
+    ctx.playerBounds = worldBounds(world.get<Transform>(ctx.game.player), world.get<Bounds>(ctx.game.player));
+    ctx.playerStep = Vec2(ctx.playerBounds.left, ctx.playerBounds.top) - ctx.game.lastPlayerPosition;
+    ctx.playerMask = &ctx.assets.maskFor(world.get<Renderable>(ctx.game.player).texture);
+
+    std::vector<StepScratch::BulletCandidate>& bullets = ctx.game.scratch.bullets;
+    const std::size_t count = world.count<Transform, Velocity, Bounds, Renderable, Team>();
+    bullets.resize(count);
+    parallelFor(ctx.jobs, count, COLLISION_CHUNK, [&](std::size_t, std::size_t begin, std::size_t end) {
+        std::size_t i = begin;
+        world.eachInRange<Transform, Velocity, Bounds, Renderable, Team>(begin, end, [&](Entity e, Transform& transform, Velocity& velocity, Bounds& bounds, Renderable&, Team& team) {
+            StepScratch::BulletCandidate& candidate = bullets[i++];
+            candidate = StepScratch::BulletCandidate{e, team == Team::Player, 0, -1, 0, -1, -1};
+            if (!candidate.player || formation.aliveCount == 0) return;
+            const Rect bulletBounds = worldBounds(transform, bounds);
+            const Vec2 bulletStep = velocity.value * ctx.dt;
+            const Vec2 localEnd = Vec2(bulletBounds.left, bulletBounds.top) - formation.origin;
+            const Vec2 localStart = localEnd - (bulletStep - ctx.enemyStep);
+            const Rect path(std::min(localStart.x, localEnd.x), std::min(localStart.y, localEnd.y),
+                            scalarAbs(localEnd.x - localStart.x) + bulletBounds.width, scalarAbs(localEnd.y - localStart.y) + bulletBounds.height);
+            if (!formation.cellRange(path, candidate.c0, candidate.c1, candidate.r0, candidate.r1)) candidate.c1 = -1;
+        });
+    });
+}
+
+// Faza dokładna: swept AABB po całym kroku, potem maski pikseli. Liczona równolegle na formacji
+// z początku fazy; trafienia, które zależą od wcześniejszych pocisków, rozstrzyga resolveCollisions.
+void collisionNarrowPhase(StepContext& ctx) {
+    if (!ctx.playing) return;
+    World& world = ctx.game.world;
+    std::vector<StepScratch::BulletCandidate>& bullets = ctx.game.scratch.bullets;
+    parallelFor(ctx.jobs, bullets.size(), COLLISION_CHUNK, [&](std::size_t, std::size_t begin, std::size_t end) {
+        std::size_t i = begin;
+        world.eachInRange<Transform, Velocity, Bounds, Renderable, Team>(begin, end, [&](Entity, Transform& transform, Velocity& velocity, Bounds& bounds, Renderable& look, Team&) {
+            StepScratch::BulletCandidate& candidate = bullets[i++];
+            const Rect bulletBounds = worldBounds(transform, bounds);
+            const Vec2 bulletStep = velocity.value * ctx.dt;
+            const CollisionMask& bulletMask = ctx.assets.maskFor(look.texture);
+            if (!candidate.player) {
+                candidate.target = firstContact(bulletMask, bulletBounds, bulletStep, *ctx.playerMask, ctx.playerBounds, ctx.playerStep) >= Scalar(0) ? 0 : -1;
+            } else if (candidate.c0 <= candidate.c1) {
+                candidate.target = earliestHitCell(ctx, bulletBounds, bulletStep, bulletMask, candidate.c0, candidate.c1, candidate.r0, candidate.r1);
+            }
+        });
+    });
+}
+
+// Skutki kolizji po kolei, jak w pętli sekwencyjnej: pierwszy pocisk wroga trafiający gracza kończy
+// grę, potem pociski gracza zabijają wrogów w kolejności encji, na końcu gracz z formacją i wygrana
+void resolveCollisions(StepContext& ctx) {
+    if (!ctx.playing) return;
+    Game& game = ctx.game;
+    World& world = game.world;
+    Formation& formation = game.formation;
+    const std::vector<StepScratch::BulletCandidate>& bullets = game.scratch.bullets;
+    for (const StepScratch::BulletCandidate& candidate : bullets) {
+        if (!candidate.player && candidate.target >= 0) {
+            game.commands.despawn(candidate.bullet);
+            killPlayer(game);
+            ctx.playing = false;
+            return;
+        }
+    }
+
+    // Kolizje Pocisków Gracza z Wrogami: trafiony jest wróg o najwcześniejszym czasie zderzenia w kroku,
+    // więc szybki pocisk przy długiej klatce nie przeskoczy wroga ani nie trafi tego dalej w kolumnie.
+    // Cel z fazy dokładnej jest minimum po większym zbiorze żywych, więc jeśli wciąż żyje, to jest też
+    // celem teraz; zabity wcześniej w tym kroku oznacza ponowne szukanie wśród pozostałych.
+    for (const StepScratch::BulletCandidate& candidate : bullets) {
+        if (!candidate.player || formation.aliveCount == 0) continue;
+        int target = candidate.target;
+        if (target >= 0 && !formation.isAlive(target)) {
+            const Rect bulletBounds = worldBounds(world.get<Transform>(candidate.bullet), world.get<Bounds>(candidate.bullet));
+            target = earliestHitCell(ctx, bulletBounds, world.get<Velocity>(candidate.bullet).value * ctx.dt,
+                                     ctx.assets.maskFor(world.get<Renderable>(candidate.bullet).texture),
+                                     candidate.c0, candidate.c1, candidate.r0, candidate.r1);
+        }
+        if (target >= 0) {
+            createEnemyExplosion(game, centerOf(formation.cellBounds(target)));
+            formation.kill(target);
+            game.commands.despawn(candidate.bullet);
+            game.score += 10;
+        }
+    }
+
+    // Kolizje Gracza z Wrogami (komórki pod prostokątem gracza)
+    const Rect& playerBounds = ctx.playerBounds;
+    const Vec2 playerPos(playerBounds.left, playerBounds.top);
+    const CollisionMask& enemyMask = ctx.assets.maskFor(TextureId::Enemy);
+    int c0, c1, r0, r1;
+    if (formation.cellRange(Rect(playerPos - formation.origin, Vec2(playerBounds.width, playerBounds.height)), c0, c1, r0, r1)) {
+        for (int row = r0; row <= r1; ++row) {
+            for (int column = c0; column <= c1; ++column) {
+                const int cell = row * formation.columns + column;
+                const Rect enemy = formation.cellBounds(cell);
+                if (formation.isAlive(cell) && playerBounds.intersects(enemy) &&
+                    masksOverlap(*ctx.playerMask, playerPos, enemyMask, Vec2(enemy.left, enemy.top))) {
+                    killPlayer(game);
+                    ctx.playing = false;
+                    return;
+                }
+            }
+        }
+    }
+
+    // Sprawdzenie warunku wygranej (nurkujący też muszą zginąć)
+    if (formation.aliveCount == 0 && game.divers == 0) {
+        game.state = GameState::LevelWon;
+        ++game.wavesCleared;
+    }
+}
+
+// --- Aktualizacja Cząsteczek (Zawsze) ---
+template <typename Config>
+void updateParticles(StepContext& ctx) {
+    World& world = ctx.game.world;
+    std::vector<CommandBuffer>& buffers = ctx.game.scratch.particleCommands;
+    const std::size_t count = world.count<Transform, Velocity, Renderable, Lifetime>();
+    buffers.resize(chunkCount(count, PARTICLE_CHUNK));
+    const float deltaTime = ctx.deltaTime;
+    parallelFor(ctx.jobs, count, PARTICLE_CHUNK, [&](std::size_t chunk, std::size_t begin, std::size_t end) {
+        CommandBuffer& commands = buffers[chunk];
+        world.eachInRange<Transform, Velocity, Renderable, Lifetime>(begin, end, [&](Entity e, Transform& transform, Velocity& velocity, Renderable& look, Lifetime& lifetime) {
+            lifetime.remaining -= deltaTime;
+            if (lifetime.remaining <= 0) {
+                commands.despawn(e);
+                return;
+            }
+            transform.position += velocity.value * Scalar(deltaTime);
+            const Scalar diameter = 2.f * look.radius;
+            if (outsideScreen<Config>(Rect(transform.position, Vec2(diameter, diameter)))) {
+                commands.despawn(e); // Poza ekranem do końca życia, nie ma czego rysować
+                return;
+            }
+            float alphaRatio = std::max(0.f, lifetime.remaining / 1.2f);
+            look.color.a = static_cast<sf::Uint8>(200 * alphaRatio);
+        });
+    });
+}
+
+// Fazy w kolejności kodu sekwencyjnego. Równolegle idą ruch pocisków, ruch i strzelanie formacji
+// oraz cząsteczki (cały krok, po spawnach skryptów); kolizje czekają na wszystkie ruchy i przechwytywanie.
+template <typename Config>
+TaskGraph<StepContext> buildStepGraph() {
+    TaskGraph<StepContext> graph;
+    graph.add("move bullets", 0, STEP_BULLETS, moveBullets<Config>);
+    graph.add("move formation", 0, STEP_FORMATION | STEP_PLAYER | STEP_EFFECTS, moveFormation<Config>);
+    graph.add("enemy shooting", STEP_FORMATION | STEP_PLAYER, STEP_EFFECTS, enemyShooting<Config>);
+    if (Config::ENEMY_SCRIPTS) {
+        graph.add("enemy scripts", STEP_PLAYER, STEP_FORMATION | STEP_EFFECTS | STEP_BULLETS | STEP_WORLD, runEnemyScripts);
+    }
+    graph.add("intercept bullets", STEP_PLAYER, STEP_BULLETS, interceptStep<Config>);
+    graph.add("collision broad-phase", STEP_BULLETS | STEP_FORMATION | STEP_PLAYER, STEP_CANDIDATES, collisionBroadPhase);
+    graph.add("collision narrow-phase", STEP_BULLETS | STEP_FORMATION | STEP_PLAYER, STEP_CANDIDATES, collisionNarrowPhase);
+    graph.add("resolve collisions", STEP_BULLETS | STEP_CANDIDATES, STEP_FORMATION | STEP_PLAYER | STEP_EFFECTS, resolveCollisions);
+    graph.add("particles", STEP_WORLD, STEP_PARTICLES, updateParticles<Config>);
+    return graph;
+}
+
+template <typename Config>
+const TaskGraph<StepContext>& stepGraph() {
+    static const TaskGraph<StepContext> graph = buildStepGraph<Config>();
+    return graph;
+}
+} // namespace
+
+bool loadGameImages(GameImages& images) {
+    TRACE_SCOPE("load images");
+    return images.player.loadFromFile("player.png") &&
+           images.enemy.loadFromFile("enemy.jpg") &&
+           images.bullet.loadFromFile("bullet.png") &&
+           images.enemyBullet.loadFromFile("enemy_bullet.png");
+}
+
+GameAssets buildGameAssets(const GameImages& images) {
+    TRACE_SCOPE("build assets");
+    const sf::Vector2f playerSize = scaledSize(images.player, ActiveConfig::PLAYER_SCALE_FACTOR);
+    const sf::Vector2f enemySize = scaledSize(images.enemy, ActiveConfig::ENEMY_SCALE_FACTOR);
+    const sf::Vector2f bulletSize = scaledSize(images.bullet, ActiveConfig::BULLET_SCALE_FACTOR);
+    const sf::Vector2f enemyBulletSize = scaledSize(images.enemyBullet, ActiveConfig::ENEMY_BULLET_SCALE_FACTOR);
+    GameAssets assets;
+    assets.playerSize = Vec2(playerSize);
+    assets.enemySize = Vec2(enemySize);
+    assets.bulletSize = Vec2(bulletSize);
+    assets.enemyBulletSize = Vec2(enemyBulletSize);
+
+    // --- Maski kolizji (w skali ekranu) ---
+    // enemy.jpg nie ma alfy: tło to biało-szara szachownica, wycinana kluczem koloru od krawędzi
+    assets.masks[static_cast<std::size_t>(TextureId::Player)] = CollisionMask::fromAlpha(images.player, maskSize(playerSize));
+    assets.masks[static_cast<std::size_t>(TextureId::Enemy)] = CollisionMask::fromColorKey(images.enemy, maskSize(enemySize), sf::Color::White, 60);
+    assets.masks[static_cast<std::size_t>(TextureId::Bullet)] = CollisionMask::fromAlpha(images.bullet, maskSize(bulletSize));
+    assets.masks[static_cast<std::size_t>(TextureId::EnemyBullet)] = CollisionMask::fromAlpha(images.enemyBullet, maskSize(enemyBulletSize));
+    return assets;
+}
+
+std::uint32_t deriveSeed(std::uint32_t baseSeed, std::uint64_t index) {
+    std::uint64_t z = (static_cast<std::uint64_t>(baseSeed) << 32) + index + 0x9E3779B97F4A7C15ull;
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return static_cast<std::uint32_t>(z ^ (z >> 31));
+}
+
+void fillCells(std::uint64_t* words, int cells) {
+    const std::size_t full = static_cast<std::size_t>(cells) / 64;
+    for (std::size_t w = 0; w < full; ++w) words[w] = ~std::uint64_t(0);
+    if (cells % 64) words[full] = (std::uint64_t(1) << (cells % 64)) - 1;
+}
+
+int aliveRange(const std::uint64_t* words, int cells, int columns, int& firstColumn, int& lastColumn, int& firstRow, int& lastRow) {
+    firstColumn = columns;
+    lastColumn = -1;
+    firstRow = cells;
+    lastRow = -1;
+    int count = 0;
+    const std::size_t wordCount = cellWords(cells);
+    for (std::size_t w = 0; w < wordCount; ++w) {
+        for (std::uint64_t bits = words[w]; bits; bits &= bits - 1) {
+            const int cell = static_cast<int>(w * 64) + std::countr_zero(bits);
+            firstColumn = std::min(firstColumn, cell % columns);
+            lastColumn = std::max(lastColumn, cell % columns);
+            firstRow = std::min(firstRow, cell / columns);
+            lastRow = cell / columns;
+            ++count;
+        }
+    }
+    return count;
+}
+
+void Formation::reset(int columnCount, int rowCount, Vec2 topLeft, Vec2 cellSpacing, Vec2 size) {
+    columns = columnCount;
+    rows = rowCount;
+    origin = topLeft;
+    spacing = cellSpacing;
+    enemySize = size;
+    alive.resize(cellWords(columns * rows));
+    fillCells(alive.data(), columns * rows);
+    aliveCount = columns * rows;
+    firstColumn = 0;
+    lastColumn = columns - 1;
+    firstRow = 0;
+    lastRow = rows - 1;
+    generation = nextFormationGeneration.fetch_add(1, std::memory_order_relaxed);
+}
+
+void Formation::kill(int cell) {
+    if (!isAlive(cell)) return;
+    clearCellBit(alive.data(), cell);
+    generation = nextFormationGeneration.fetch_add(1, std::memory_order_relaxed);
+    // Zasięg żywych komórek od nowa (tylko przy zabiciu, nie co klatkę)
+    aliveCount = aliveRange(alive.data(), cellCount(), columns, firstColumn, lastColumn, firstRow, lastRow);
+}
+
+void Formation::setAlive(const std::vector<std::uint64_t>& cells) {
+    std::vector<std::uint64_t> mask(alive.size());
+    fillCells(mask.data(), cellCount());
+    for (std::size_t w = 0; w < alive.size(); ++w) alive[w] = w < cells.size() ? cells[w] & mask[w] : 0;
+    generation = nextFormationGeneration.fetch_add(1, std::memory_order_relaxed);
+    aliveCount = aliveRange(alive.data(), cellCount(), columns, firstColumn, lastColumn, firstRow, lastRow);
+}
+
+Rect Formation::aliveBounds() const {
+    if (aliveCount == 0) return Rect(origin, Vec2());
+    return Rect(origin.x + firstColumn * spacing.x, origin.y + firstRow * spacing.y,
+                (lastColumn - firstColumn) * spacing.x + enemySize.x, (lastRow - firstRow) * spacing.y + enemySize.y);
+}
+
+bool Formation::cellRange(const Rect& local, int& c0, int& c1, int& r0, int& r1) const {
+    // Komórka c nachodzi na [left, right), gdy c * spacing < right i c * spacing + size > left
+    c0 = std::max(0, floorToInt((local.left - enemySize.x) / spacing.x));
+    c1 = std::min(columns - 1, floorToInt((local.left + local.width) / spacing.x));
+    r0 = std::max(0, floorToInt((local.top - enemySize.y) / spacing.y));
+    r1 = std::min(rows - 1, floorToInt((local.top + local.height) / spacing.y));
+    return c0 <= c1 && r0 <= r1;
+}
+
+Vec2 formationStart(Vec2 enemySize) {
+    return formationStartFor<ActiveConfig>(enemySize);
+}
+
+void resetGame(Game& game, const GameAssets& assets) {
+    TRACE_SCOPE("reset game");
+    game.score = 0;
+    game.survivalTime = 0.f;
+    game.wavesCleared = 0;
+    game.steps = 0;
+    spawnWave<ActiveConfig>(game, assets);
+}
+
+void startNextWave(Game& game, const GameAssets& assets) {
+    spawnWave<ActiveConfig>(game, assets);
+}
+
+float enemyShotElapsed(const Game& game) {
+    if (!game.timers.pending(game.enemyShotTimer)) return 0.f;
+    const std::uint64_t usPerTick = 1000000 / TIMER_TICKS_PER_SECOND;
+    const std::uint64_t leftUs = game.timers.remaining(game.enemyShotTimer) * usPerTick - game.waveTimeUs % usPerTick;
+    return std::max(0.f, ENEMY_SHOOT_INTERVAL - leftUs / 1.0e6f);
+}
+
+void restartEnemyScripts(Game& game) {
+    if (!ActiveConfig::ENEMY_SCRIPTS || game.versus) return;
+    std::vector<Entity> divers;
+    game.world.each<Renderable, Team>([&](Entity e, Renderable& look, Team& team) {
+        if (isDiver(look, team)) divers.push_back(e);
+    });
+    for (Entity diver : divers) game.scripts.start(steerDiver, diver);
+}
+
+void restoreEnemyShotTimer(Game& game, float elapsed) {
+    game.scripts.clear();
+    game.scripts.requestRestart(); // Nurkujący z migawki dostaną skrypty w pierwszym kroku
+    game.timers.clear();
+    game.waveTimeUs = 0;
+    game.enemyShotTimer = game.versus ? TimerWheel::Handle() : game.timers.schedule(
+        secondsToTicks(ENEMY_SHOOT_INTERVAL - elapsed), static_cast<std::uint32_t>(TimerEvent::EnemyShot));
+}
+
+void movePlayer(Game& game, float dx) {
+    Transform& playerTransform = game.world.get<Transform>(game.player);
+    const Vec2 playerSize = game.world.get<Bounds>(game.player).size;
+    playerTransform.position.x += dx;
+
+    // Ograniczenie ruchu gracza
+    if (playerTransform.position.x < Scalar(0)) playerTransform.position.x = 0;
+    if (playerTransform.position.x + playerSize.x > Scalar(SCREEN_WIDTH)) playerTransform.position.x = Scalar(SCREEN_WIDTH) - playerSize.x;
+}
+
+void fireBullet(Game& game, const GameAssets& assets, float sinceStepStart) {
+    const Rect playerBounds = worldBounds(game.world.get<Transform>(game.player), game.world.get<Bounds>(game.player));
+    // System ruchu przesunie pocisk o cały krok, więc cofamy go o czas od początku kroku do strzału
+    game.commands.spawn(
+        Transform{Vec2(
+            playerBounds.left + playerBounds.width / Scalar(2) - assets.bulletSize.x / Scalar(2),
+            playerBounds.top - assets.bulletSize.y + Scalar(BULLET_SPEED) * Scalar(sinceStepStart))},
+        Velocity{Vec2(0, -Scalar(BULLET_SPEED))},
+        Bounds{assets.bulletSize},
+        Renderable{TextureId::Bullet},
+        Team::Player);
+}
+
+void fireEnemyBullet(Game& game, const GameAssets& assets, const Rect& shooter) {
+    fireEnemyBullet(game, assets, shooter, Vec2(0, Scalar(ENEMY_BULLET_SPEED)));
+}
+
+void fireEnemyBullet(Game& game, const GameAssets& assets, const Rect& shooter, Vec2 velocity) {
+    game.commands.spawn(
+        Transform{Vec2(
+            shooter.left + shooter.width / Scalar(2) - assets.enemyBulletSize.x / Scalar(2),
+            shooter.top + shooter.height)},
+        Velocity{velocity},
+        Bounds{assets.enemyBulletSize},
+        Renderable{TextureId::EnemyBullet},
+        Team::Enemy);
+}
+
+void stepGame(Game& game, const GameAssets& assets, float deltaTime, JobSystem* jobs) {
+    TRACE_SCOPE("simulate");
+    game.world.apply(game.commands); // Nowe pociski gracza ruszają już w tym kroku
+
+    const bool playing = game.state == GameState::Playing;
+    if (playing) {
+        ++game.steps;
+        game.survivalTime += deltaTime;
+        game.waveTimeUs += static_cast<std::uint64_t>(std::lround(deltaTime * 1.0e6f));
+        game.scratch.timerEvents.clear();
+        game.timers.advance(game.waveTimeUs * TIMER_TICKS_PER_SECOND / 1000000, game.scratch.timerEvents);
+    }
+    StepContext ctx{game, assets, jobs, deltaTime, Scalar(deltaTime), playing, playing, Vec2(), Rect(), Vec2(), nullptr};
+    stepGraph<ActiveConfig>().run(ctx, jobs);
+
+    // Komendy w kolejności kodu sekwencyjnego: ruch pocisków, fazy Playing, cząsteczki
+    StepScratch& scratch = game.scratch;
+    for (CommandBuffer& buffer : scratch.bulletCommands) scratch.merged.append(buffer);
+    scratch.merged.append(game.commands);
+    for (CommandBuffer& buffer : scratch.particleCommands) scratch.merged.append(buffer);
+
+    // Wykonaj odroczone spawny i usunięcia z tego kroku
+    game.world.apply(scratch.merged);
+    if (game.world.isAlive(game.player)) game.lastPlayerPosition = game.world.get<Transform>(game.player).position;
+}
@@ -0,0 +1,243 @@
+﻿#pragma once
+#include <SFML/Graphics.hpp>
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+#include "collision_mask.h"
+#include "ecs.h"
+#include "enemy_script.h"
+#include "game_config.h"
+#include "random.h"
+#include "timer_wheel.h"
+
+// --- Stałe aktywnej konfiguracji (game_config.h) dla kodu poza pętlą aktualizacji ---
+const float SCREEN_WIDTH = ActiveConfig::SCREEN_WIDTH;
+const float SCREEN_HEIGHT = ActiveConfig::SCREEN_HEIGHT;
+const float PLAYER_SPEED = ActiveConfig::PLAYER_SPEED;
+const float BULLET_SPEED = ActiveConfig::BULLET_SPEED;
+const float ENEMY_SPEED = ActiveConfig::ENEMY_SPEED;
+const float ENEMY_DROP_DISTANCE = ActiveConfig::ENEMY_DROP_DISTANCE;
+const float ENEMY_BULLET_SPEED = ActiveConfig::ENEMY_BULLET_SPEED;
+const float ENEMY_SHOOT_INTERVAL = ActiveConfig::ENEMY_SHOOT_INTERVAL;
+const float PLAYER_SHOOT_INTERVAL = ActiveConfig::PLAYER_SHOOT_INTERVAL;
+
+const int FORMATION_COLUMNS = ActiveConfig::FORMATION_COLUMNS;
+const int FORMATION_ROWS = ActiveConfig::FORMATION_ROWS;
+const float FORMATION_SPACING = ActiveConfig::FORMATION_SPACING;
+const float FORMATION_TOP = ActiveConfig::FORMATION_TOP;
+
+// --- Koło timerów gry ---
+// Odliczania rozgrywki to timery w Game::timers z tickiem 1 ms czasu symulacji; koło przesuwa się raz
+// na krok, a wygasłe zdarzenia odbierają fazy kroku. Zdarzenie to rodzaj w najniższym bajcie
+// i dane wyżej (ScriptWake: slot skryptu w EnemyScripts).
+enum class TimerEvent : std::uint32_t { EnemyShot, ScriptWake };
+
+const std::uint32_t TIMER_TICKS_PER_SECOND = 1000;
+
+inline std::uint32_t timerEvent(TimerEvent kind, std::uint32_t payload) {
+    return static_cast<std::uint32_t>(kind) | payload << 8;
+}
+inline TimerEvent timerEventKind(std::uint32_t event) { return static_cast<TimerEvent>(event & 0xFFu); }
+inline std::uint32_t timerEventPayload(std::uint32_t event) { return event >> 8; }
+
+inline TimerWheel::Tick secondsToTicks(float seconds) {
+    return static_cast<TimerWheel::Tick>(std::lround(std::max(0.f, seconds) * TIMER_TICKS_PER_SECOND));
+}
+
+// --- Stany Gry ---
+enum class GameState { MainMenu, Playing, GameOver, LevelWon };
+
+// Maski kolizji w kolejności TextureId
+using CollisionMaskTable = std::array<CollisionMask, static_cast<std::size_t>(TextureId::Count)>;
+
+// --- Zasoby symulacji ---
+// Same obrazy (sf::Image) nie potrzebują kontekstu OpenGL, więc wystarczają też w trybie bez okna
+struct GameImages {
+    sf::Image player;
+    sf::Image enemy;
+    sf::Image bullet;
+    sf::Image enemyBullet;
+};
+
+bool loadGameImages(GameImages& images);
+
+// Rozmiary na ekranie i maski kolizji; po zbudowaniu tylko do odczytu, wspólne dla wszystkich instancji gry
+struct GameAssets {
+    Vec2 playerSize;
+    Vec2 enemySize;
+    Vec2 bulletSize;
+    Vec2 enemyBulletSize;
+    CollisionMaskTable masks;
+
+    const CollisionMask& maskFor(TextureId texture) const { return masks[static_cast<std::size_t>(texture)]; }
+};
+
+GameAssets buildGameAssets(const GameImages& images);
+
+// Ziarno instancji wyprowadzone z ziarna bazowego (mieszanie splitmix64), żeby sąsiednie gry nie były skorelowane
+std::uint32_t deriveSeed(std::uint32_t baseSeed, std::uint64_t index);
+
+// Lewy górny róg formacji na początku fali (wyśrodkowanej w poziomie)
+Vec2 formationStart(Vec2 enemySize);
+
+// --- Bitset komórek formacji ---
+// Bit komórki cell to bit cell % 64 słowa cell / 64, więc formacja może mieć dowolnie wiele komórek
+// (fale po tysiąc wrogów), a przeglądanie żywych idzie po słowach i ustawionych bitach
+inline std::size_t cellWords(int cells) { return (static_cast<std::size_t>(cells) + 63) / 64; }
+inline bool cellBit(const std::uint64_t* words, int cell) { return (words[cell >> 6] >> (cell & 63)) & 1u; }
+inline void clearCellBit(std::uint64_t* words, int cell) { words[cell >> 6] &= ~(std::uint64_t(1) << (cell & 63)); }
+
+// Ustawia bity komórek [0, cells), pozostałe bity słów zeruje
+void fillCells(std::uint64_t* words, int cells);
+
+// Liczba żywych komórek siatki o columns kolumnach i zasięg ich kolumn i wierszy (pusty: first > last)
+int aliveRange(const std::uint64_t* words, int cells, int columns, int& firstColumn, int& lastColumn, int& firstRow, int& lastRow);
+
+// --- Formacja wrogów ---
+// Wrogowie nie są encjami: formacja to siatka komórek przesuwana jako sztywna całość. Komórka (c, r)
+// leży w origin + (c * spacing.x, r * spacing.y), więc ruch formacji to jedno dodawanie wektora,
+// a punkt ekranu mapuje się na komórki dzieleniem przez odstęp, bez przeglądania wrogów.
+struct Formation {
+    int columns = 0;
+    int rows = 0;
+    Vec2 origin;    // Lewy górny róg komórki (0, 0) na ekranie
+    Vec2 spacing;   // Odstęp komórek (rozmiar wroga * FORMATION_SPACING)
+    Vec2 enemySize;
+    std::vector<std::uint64_t> alive; // Bitset komórek wiersz po wierszu (cellBit), 1 = żywy wróg
+    int aliveCount = 0;
+    // Zasięg żywych komórek, przeliczany tylko przy zabiciu (krawędzie i dno bez pętli po wrogach)
+    int firstColumn = 0;
+    int lastColumn = -1;
+    int firstRow = 0;
+    int lastRow = -1;
+    // Nowa wartość przy każdej zmianie żywych komórek; kopie gry (rollback) dzielą ją z oryginałem,
+    // więc równa generacja oznacza te same komórki (klucz geometrii w pamięci podręcznej rysowania)
+    std::uint64_t generation = 0;
+
+    // Pełna siatka żywych wrogów
+    void reset(int columnCount, int rowCount, Vec2 topLeft, Vec2 cellSpacing, Vec2 size);
+    void kill(int cell);
+    // Żywe komórki z bitsetu (migawki); brakujące słowa to martwe komórki
+    void setAlive(const std::vector<std::uint64_t>& cells);
+
+    int cellCount() const { return columns * rows; }
+    bool isAlive(int cell) const { return cellBit(alive.data(), cell); }
+    // Pozycja komórki względem origin
+    Vec2 cellOffset(int cell) const {
+        return Vec2((cell % columns) * spacing.x, (cell / columns) * spacing.y);
+    }
+    Rect cellBounds(int cell) const { return Rect(origin + cellOffset(cell), enemySize); }
+    // Prostokąt na ekranie obejmujący żywych wrogów (pusty, gdy aliveCount == 0)
+    Rect aliveBounds() const;
+    // Zakres kolumn [c0, c1] i wierszy [r0, r1], których komórki mogą nachodzić na prostokąt w układzie
+    // formacji (względem origin); false, gdy żadna komórka siatki
+    bool cellRange(const Rect& local, int& c0, int& c1, int& r0, int& r1) const;
+};
+
+// --- Przechwytywanie pocisków (sweep and prune) ---
+// Pociski gracza i wrogów w dwóch listach posortowanych po lewej krawędzi toru w kroku; zderzenia
+// sprawdza tylko para pocisków, których zakresy x nachodzą na siebie. Listy żyją między krokami:
+// pociski lecą pionowo, więc kolejność prawie się nie zmienia i sortowanie przez wstawianie ją
+// poprawia w czasie liniowym, a nowe pociski są dopisywane na końcu.
+struct BulletSweep {
+    struct Entry {
+        Scalar left; // Zakres x toru pocisku w bieżącym kroku
+        Scalar right;
+        Entity bullet;
+        bool intercepted;
+    };
+    std::vector<Entry> player;
+    std::vector<Entry> enemy;
+    std::vector<std::uint32_t> listed; // Po indeksie encji: generacja + 1, gdy ta encja jest na liście
+    std::vector<std::uint32_t> activePlayer; // Pozycje w player/enemy z zakresem x nad miotłą
+    std::vector<std::uint32_t> activeEnemy;
+};
+
+// --- Bufory kroku podzielonego na zadania (stepGame z pulą) ---
+// Duże pętle idą porcjami o stałej wielkości; każda porcja pisze do własnego bufora, a bufory są
+// scalane w kolejności porcji, więc wynik kroku nie zależy od liczby wątków. Pamięć zostaje między krokami.
+struct StepScratch {
+    // Pocisk w kolejności world.each<Transform, Velocity, Bounds, Renderable, Team>
+    struct BulletCandidate {
+        Entity bullet;
+        bool player;        // Pocisk gracza (cel: formacja) albo wroga (cel: gracz)
+        int c0, c1, r0, r1; // Faza wstępna: komórki formacji pod torem pocisku gracza (c0 > c1: żadne)
+        int target;         // Faza dokładna: najwcześniej trafiona komórka, u wroga 0 = trafia gracza; -1: nic
+    };
+    std::vector<CommandBuffer> bulletCommands;   // Po porcji ruchu pocisków
+    std::vector<CommandBuffer> particleCommands; // Po porcji cząsteczek
+    CommandBuffer merged;
+    std::vector<BulletCandidate> bullets;
+    std::vector<std::uint32_t> timerEvents; // TimerEvent wygasłe w tym kroku
+};
+
+// --- Stan jednej rozgrywki ---
+// Bez okna, tekstów i zegarów czasu rzeczywistego: wszystkie odliczania są w sekundach symulacji,
+// a losowość pochodzi z własnych strumieni PCG, więc wiele instancji może działać równolegle.
+struct Game {
+    explicit Game(std::uint32_t seed) : random(seed) {}
+
+    GameState state = GameState::MainMenu;
+    World world;            // Gracz, wrogowie, pociski i cząsteczki
+    CommandBuffer commands; // Spawny/usunięcia z systemów, wykonywane przez world.apply()
+    Entity player;          // Gracz jest tworzony w resetGame()
+    Formation formation;    // Wrogowie
+    BulletSweep bulletSweep; // Przechwytywanie pocisków (Config::BULLET_INTERCEPTION)
+    StepScratch scratch;
+
+    int score = 0;
+    float enemyDirection = 1.0f;
+    bool moveEnemiesDown = false;   // Flaga do przesuwania wrogów w dół
+    TimerWheel timers;              // Odliczania fali w czasie symulacji (TimerEvent)
+    std::uint64_t waveTimeUs = 0;   // Czas symulacji fali; koło dostaje pełne ticki, ułamki się nie gubią
+    TimerWheel::Handle enemyShotTimer; // Strzał losowego wroga (bez versus)
+    EnemyScripts scripts;           // Zachowania wrogów uruchomione przez strzał (Config::ENEMY_SCRIPTS)
+    int divers = 0;                 // Nurkujący wrogowie poza formacją (fala trwa, dopóki są)
+    bool versus = false;            // Formacją strzela drugi gracz (stepVersus), bez losowego strzelca
+    Vec2 lastPlayerPosition; // Pozycja z końca poprzedniego kroku (ruch gracza dla swept AABB)
+    RandomService random; // Strumienie: wybór strzelca, cząsteczki
+
+    // Statystyki rozgrywki
+    float survivalTime = 0.f; // Sekundy symulacji w stanie Playing
+    int wavesCleared = 0;
+    unsigned long steps = 0;
+};
+
+// Nowa gra od zera: wynik 0, świeży gracz i pełna formacja wrogów
+void resetGame(Game& game, const GameAssets& assets);
+
+// Kolejna fala po LevelWon: wynik i statystyki zostają, gracz wraca na start
+void startNextWave(Game& game, const GameAssets& assets);
+
+// Nurkujący wróg to encja z drużyny wrogów (ruch i kolizje jak pocisk) z teksturą wroga
+inline bool isDiver(const Renderable& look, Team team) { return team == Team::Enemy && look.texture == TextureId::Enemy; }
+
+// Skrypty dla nurkujących wrogów, którzy ich nie mają (stan odtworzony z migawki albo kopia gry);
+// wywołuje EnemyScripts::update po requestRestart() i po skopiowaniu
+void restartEnemyScripts(Game& game);
+
+// Sekundy od ostatniego strzału wrogów i ich odtworzenie (migawki). Ustawienie zaczyna koło fali od nowa,
+// z samym timerem strzału, bo to jedyne odliczanie zapisywane w migawce (skrypty wrogów są przerywane).
+float enemyShotElapsed(const Game& game);
+void restoreEnemyShotTimer(Game& game, float elapsed);
+
+// Przesuwa gracza w poziomie z ograniczeniem do ekranu
+void movePlayer(Game& game, float dx);
+
+// Pocisk gracza wystrzelony sinceStepStart sekund po początku bieżącego kroku
+void fireBullet(Game& game, const GameAssets& assets, float sinceStepStart);
+
+// Pocisk wroga spod środka prostokąta strzelca (prosto w dół albo z podaną prędkością)
+void fireEnemyBullet(Game& game, const GameAssets& assets, const Rect& shooter);
+void fireEnemyBullet(Game& game, const GameAssets& assets, const Rect& shooter, Vec2 velocity);
+
+class JobSystem;
+
+// Jeden krok symulacji; wejście gracza (movePlayer/fireBullet) musi być zastosowane wcześniej.
+// Fazy kroku to graf zadań: z pulą jobs niezależne fazy i porcje dużych pętli idą równolegle,
+// a wynik jest bit w bit taki sam jak bez puli (powtórki i rollback działają przy każdej liczbie wątków).
+void stepGame(Game& game, const GameAssets& assets, float deltaTime, JobSystem* jobs);
+inline void stepGame(Game& game, const GameAssets& assets, float deltaTime) { stepGame(game, assets, deltaTime, nullptr); }
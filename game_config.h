@@ -0,0 +1,57 @@
+﻿#pragma once
+
+// --- Konfiguracja gry znana w czasie kompilacji ---
+// Każda konfiguracja to typ ze stałymi static constexpr, przekazywany jako parametr szablonu do kodu
+// aktualizacji (stepGame), więc kompilator widzi je jako stałe w obliczeniach kroku.
+// Wariant buildu wybiera opcja CMake GALAXY_CONFIG (definicja GALAXY_CONFIG), bez zmian w kodzie.
+struct DefaultConfig {
+    static constexpr float SCREEN_WIDTH = 800.0f;
+    static constexpr float SCREEN_HEIGHT = 600.0f;
+    static constexpr float PLAYER_SPEED = 250.0f;
+    static constexpr float BULLET_SPEED = 500.0f;
+    static constexpr float ENEMY_SPEED = 35.0f;
+    static constexpr float ENEMY_DROP_DISTANCE = 1.0f;
+    static constexpr float ENEMY_BULLET_SPEED = 250.0f;
+    static constexpr float ENEMY_SHOOT_INTERVAL = 1.5f;
+    static constexpr float PLAYER_SHOOT_INTERVAL = 0.4f;
+    static constexpr bool BULLET_INTERCEPTION = true; // Pociski gracza zestrzeliwują pociski wrogów
+    static constexpr bool ENEMY_SCRIPTS = true; // Strzał wroga uruchamia skrypt (seria, wachlarz, nurkowanie)
+
+    // Formacja wrogów: siatka FORMATION_ROWS x FORMATION_COLUMNS, odstęp = rozmiar wroga * FORMATION_SPACING
+    static constexpr int FORMATION_COLUMNS = 10;
+    static constexpr int FORMATION_ROWS = 4;
+    static constexpr float FORMATION_SPACING = 1.4f;
+    static constexpr float FORMATION_TOP = 60.0f;
+
+    // Skala sprite'ów względem rozmiaru obrazów
+    static constexpr float PLAYER_SCALE_FACTOR = 0.04f;
+    static constexpr float ENEMY_SCALE_FACTOR = 0.05f;
+    static constexpr float BULLET_SCALE_FACTOR = 0.1f;
+    static constexpr float ENEMY_BULLET_SCALE_FACTOR = 0.05f;
+};
+
+// Automat: monitor 4:3 640x480 i szybsze tempo
+struct ArcadeConfig : DefaultConfig {
+    static constexpr float SCREEN_WIDTH = 640.0f;
+    static constexpr float SCREEN_HEIGHT = 480.0f;
+    static constexpr float ENEMY_SPEED = 45.0f;
+    static constexpr float ENEMY_DROP_DISTANCE = 2.0f;
+    static constexpr float ENEMY_SHOOT_INTERVAL = 1.0f;
+    static constexpr float PLAYER_SHOOT_INTERVAL = 0.3f;
+    static constexpr float FORMATION_TOP = 40.0f;
+};
+
+// Test obciążenia: pełne 64 komórki formacji, częsty ogień z obu stron
+struct StressConfig : DefaultConfig {
+    static constexpr float ENEMY_SPEED = 60.0f;
+    static constexpr float ENEMY_SHOOT_INTERVAL = 0.2f;
+    static constexpr float PLAYER_SHOOT_INTERVAL = 0.1f;
+    static constexpr int FORMATION_COLUMNS = 16;
+    static constexpr float FORMATION_SPACING = 1.3f;
+    static constexpr float ENEMY_SCALE_FACTOR = 0.04f;
+};
+
+#ifndef GALAXY_CONFIG
+#define GALAXY_CONFIG DefaultConfig
+#endif
+using ActiveConfig = GALAXY_CONFIG;
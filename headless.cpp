@@ -0,0 +1,315 @@
+﻿#include "headless.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <thread>
+#include <vector>
+#include "batch_env.h"
+#include "game.h"
+#include "software_renderer.h"
+#include "trace.h"
+
+namespace {
+const float HEADLESS_STEP = 1.0f / 60.0f; // Stały krok symulacji (jak gra w oknie przy 60 FPS)
+const int RANDOM_BOT_DECISION_STEPS = 15;  // Bot losowy zmienia decyzję co 0.25 s
+const std::uint64_t BOT_STREAM = 0xB07;    // Strumień PCG bota, rozłączny ze strumieniami gry
+const int GOLDEN_TOLERANCE = 8;            // Różnica kanału (0-255) uznawana za ten sam kolor
+const double GOLDEN_MAX_MISMATCH = 0.001;  // Udział pikseli ponad tolerancją, przy którym klatka jest inna
+
+struct GameResult {
+    std::uint32_t seed;
+    int score;
+    float survivalTime;
+    int wavesCleared;
+    unsigned long frames;
+};
+
+// --- Skrypt sterujący graczem ---
+struct BotCommand {
+    float move; // -1 w lewo, 0 stój, 1 w prawo
+    bool fire;
+};
+
+class Bot {
+public:
+    Bot(bool random, std::uint32_t seed) : m_random(random), m_rng(seed, BOT_STREAM) {}
+
+    BotCommand decide(Game& game) {
+        return m_random ? decideRandom() : decideTracker(game);
+    }
+
+private:
+    // Losowy ruch i ogień, odnawiane co RANDOM_BOT_DECISION_STEPS kroków
+    BotCommand decideRandom() {
+        if (m_stepsLeft-- <= 0) {
+            m_command = BotCommand{static_cast<float>(static_cast<int>(m_rng.below(3)) - 1), m_rng.below(2) != 0};
+            m_stepsLeft = RANDOM_BOT_DECISION_STEPS;
+        }
+        return m_command;
+    }
+
+    // Podjeżdża pod najbliższego w poziomie żywego wroga i strzela, gdy jest pod nim
+    BotCommand decideTracker(Game& game) {
+        const sf::FloatRect player(worldBounds(game.world.get<Transform>(game.player), game.world.get<Bounds>(game.player)));
+        const float playerCenter = player.left + player.width / 2.f;
+        const Formation& formation = game.formation;
+        int target = -1;
+        float bestDistance = SCREEN_WIDTH;
+        for (int cell = 0; cell < formation.cellCount(); ++cell) {
+            const sf::FloatRect enemy(formation.cellBounds(cell));
+            const float distance = std::abs(enemy.left + enemy.width / 2.f - playerCenter);
+            if (formation.isAlive(cell) && distance < bestDistance) {
+                bestDistance = distance;
+                target = cell;
+            }
+        }
+        if (target < 0) return BotCommand{0.f, false};
+        const sf::FloatRect enemy(formation.cellBounds(target));
+        const float dx = enemy.left + enemy.width / 2.f - playerCenter;
+        const float deadZone = PLAYER_SPEED * HEADLESS_STEP;
+        return BotCommand{dx > deadZone ? 1.f : (dx < -deadZone ? -1.f : 0.f), std::abs(dx) < enemy.width / 2.f};
+    }
+
+    bool m_random;
+    Pcg32 m_rng;
+    BotCommand m_command{0.f, false};
+    int m_stepsLeft = 0;
+};
+
+// Jeden krok gry sterowanej botem
+void stepBotGame(Game& game, const GameAssets& assets, Bot& bot, float& sinceLastShot) {
+    const BotCommand command = bot.decide(game);
+    movePlayer(game, command.move * PLAYER_SPEED * HEADLESS_STEP);
+    sinceLastShot += HEADLESS_STEP;
+    if (command.fire && sinceLastShot >= PLAYER_SHOOT_INTERVAL) {
+        fireBullet(game, assets, 0.f);
+        sinceLastShot = 0.f;
+    }
+    stepGame(game, assets, HEADLESS_STEP);
+}
+
+// Jedna gra od resetu do śmierci gracza albo limitu kroków; kolejne fale startują od razu
+GameResult playGame(Game& game, const GameAssets& assets, std::uint32_t seed, const LaunchOptions& options) {
+    TRACE_SCOPE("play game");
+    game.random.reseed(seed);
+    resetGame(game, assets);
+    Bot bot(options.bot == "random", seed);
+    float sinceLastShot = 0.f;
+
+    while (game.steps < options.maxFrames) {
+        if (game.state == GameState::LevelWon) startNextWave(game, assets);
+        else if (game.state != GameState::Playing) break;
+        stepBotGame(game, assets, bot, sinceLastShot);
+    }
+    return GameResult{seed, game.score, game.survivalTime, game.wavesCleared, game.steps};
+}
+
+double percentile(std::vector<double> values, double p) {
+    std::sort(values.begin(), values.end());
+    return values[std::min(values.size() - 1, static_cast<std::size_t>(p * values.size()))];
+}
+
+// Liczba pikseli, w których któryś kanał różni się o więcej niż GOLDEN_TOLERANCE
+std::size_t countMismatchedPixels(const sf::Image& expected, const std::vector<std::uint8_t>& actual) {
+    const std::uint8_t* reference = expected.getPixelsPtr();
+    std::size_t mismatched = 0;
+    for (std::size_t i = 0; i < actual.size(); i += 4) {
+        for (std::size_t c = 0; c < 4; ++c) {
+            if (std::abs(static_cast<int>(reference[i + c]) - static_cast<int>(actual[i + c])) > GOLDEN_TOLERANCE) {
+                ++mismatched;
+                break;
+            }
+        }
+    }
+    return mismatched;
+}
+
+void writeResultsCsv(std::ostream& out, const std::vector<GameResult>& results) {
+    out << "game,seed,score,survival_s,waves_cleared,frames\n";
+    for (std::size_t i = 0; i < results.size(); ++i) {
+        const GameResult& r = results[i];
+        out << i << ',' << r.seed << ',' << r.score << ',' << r.survivalTime << ',' << r.wavesCleared << ',' << r.frames << '\n';
+    }
+}
+} // namespace
+
+int runHeadless(const LaunchOptions& options) {
+    GameImages images;
+    if (!loadGameImages(images)) {
+        std::cerr << "Headless: could not load game images\n";
+        return EXIT_FAILURE;
+    }
+    const GameAssets assets = buildGameAssets(images); // Wspólne, tylko do odczytu
+
+    const int gameCount = options.headlessGames;
+    unsigned int threadCount = options.threads > 0 ? options.threads : std::thread::hardware_concurrency();
+    threadCount = std::max(1u, std::min(threadCount, static_cast<unsigned int>(gameCount)));
+
+    // Pula wątków: każdy bierze następną grę z licznika i zapisuje wynik do własnej komórki
+    std::vector<GameResult> results(gameCount);
+    std::atomic<int> nextGame{0};
+    const auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> workers;
+    workers.reserve(threadCount);
+    for (unsigned int t = 0; t < threadCount; ++t) {
+        workers.emplace_back([&]() {
+            setTraceThreadName("headless worker");
+            Game game(0); // Jeden świat na wątek, pamięć archetypów przechodzi na kolejne gry
+            for (int i = nextGame.fetch_add(1, std::memory_order_relaxed); i < gameCount;
+                 i = nextGame.fetch_add(1, std::memory_order_relaxed)) {
+                results[i] = playGame(game, assets, deriveSeed(options.seed, static_cast<std::uint64_t>(i)), options);
+            }
+        });
+    }
+    for (auto& worker : workers) worker.join();
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    unsigned long long totalFrames = 0;
+    long long totalScore = 0;
+    double totalSurvival = 0.0;
+    long long totalWaves = 0;
+    int minScore = results.front().score;
+    int maxScore = results.front().score;
+    float maxSurvival = 0.f;
+    for (const GameResult& r : results) {
+        totalFrames += r.frames;
+        totalScore += r.score;
+        totalSurvival += r.survivalTime;
+        totalWaves += r.wavesCleared;
+        minScore = std::min(minScore, r.score);
+        maxScore = std::max(maxScore, r.score);
+        maxSurvival = std::max(maxSurvival, r.survivalTime);
+    }
+
+    std::cout << std::fixed << std::setprecision(2)
+              << "Headless: " << gameCount << " games (" << options.bot << " bot) on " << threadCount
+              << " threads in " << seconds << " s\n"
+              << "  frames:   " << totalFrames << " total, " << totalFrames / seconds << " frames/s, "
+              << gameCount / seconds << " games/s\n"
+              << "  score:    mean " << static_cast<double>(totalScore) / gameCount
+              << ", min " << minScore << ", max " << maxScore << "\n"
+              << "  survival: mean " << totalSurvival / gameCount << " s, max " << maxSurvival << " s\n"
+              << "  waves:    " << totalWaves << " cleared, mean " << static_cast<double>(totalWaves) / gameCount << "\n";
+
+    if (!options.results.empty()) {
+        std::ofstream csv(options.results);
+        if (!csv) {
+            std::cerr << "Headless: could not write " << options.results << "\n";
+            return EXIT_FAILURE;
+        }
+        writeResultsCsv(csv, results);
+    }
+    return 0;
+}
+
+int runBatch(const LaunchOptions& options) {
+    GameImages images;
+    if (!loadGameImages(images)) {
+        std::cerr << "Batch: could not load game images\n";
+        return EXIT_FAILURE;
+    }
+    const GameAssets assets = buildGameAssets(images);
+
+    const std::size_t gameCount = static_cast<std::size_t>(options.batchGames);
+    BatchEnv env(gameCount, assets, options.seed);
+    std::vector<std::uint8_t> actions(gameCount);
+    std::vector<std::uint32_t> actionRng(gameCount);
+    for (std::size_t g = 0; g < gameCount; ++g) actionRng[g] = deriveSeed(options.seed ^ 0xA5A5A5A5u, g);
+
+    const auto start = std::chrono::steady_clock::now();
+    for (unsigned long step = 0; step < options.maxFrames; ++step) {
+        // Losowe akcje z LCG na grę (3 najstarsze bity: lewo, prawo, ogień)
+        for (std::size_t g = 0; g < gameCount; ++g) {
+            actionRng[g] = actionRng[g] * 1664525u + 1013904223u;
+            actions[g] = static_cast<std::uint8_t>(actionRng[g] >> 29);
+        }
+        env.step(actions.data(), HEADLESS_STEP);
+    }
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    const double gameSteps = static_cast<double>(gameCount) * options.maxFrames;
+
+    std::cout << std::fixed << std::setprecision(2)
+              << "Batch: " << gameCount << " games x " << options.maxFrames << " steps in " << seconds << " s\n"
+              << "  steps:    " << gameSteps / seconds << " game steps/s\n"
+              << "  episodes: " << env.episodes() << " finished, mean score "
+              << (env.episodes() > 0 ? static_cast<double>(env.episodeScoreSum()) / env.episodes() : 0.0)
+              << ", " << env.wavesCleared() << " waves cleared\n";
+    return 0;
+}
+
+int runRenderCheck(const LaunchOptions& options) {
+    GameImages images;
+    if (!loadGameImages(images)) {
+        std::cerr << "Render: could not load game images\n";
+        return EXIT_FAILURE;
+    }
+    const GameAssets assets = buildGameAssets(images);
+    SoftwareRenderer renderer(static_cast<unsigned int>(SCREEN_WIDTH), static_cast<unsigned int>(SCREEN_HEIGHT), images, options.threads);
+
+    Game game(options.seed);
+    resetGame(game, assets);
+    Bot bot(false, options.seed);
+    float sinceLastShot = 0.f;
+
+    // Nagrywanie poleceń (drawGameFrame) i rasteryzacja (endFrame) mierzone osobno
+    std::vector<double> recordMs;
+    std::vector<double> rasterMs;
+    recordMs.reserve(options.renderFrames);
+    rasterMs.reserve(options.renderFrames);
+    std::size_t commands = 0;
+    for (int frame = 0; frame < options.renderFrames; ++frame) {
+        if (game.state == GameState::LevelWon) startNextWave(game, assets);
+        else if (game.state != GameState::Playing) resetGame(game, assets);
+        stepBotGame(game, assets, bot, sinceLastShot);
+
+        const auto recordStart = std::chrono::steady_clock::now();
+        drawGameFrame(renderer, game, HudState{game.score, false, game.steps * HEADLESS_STEP});
+        const auto rasterStart = std::chrono::steady_clock::now();
+        renderer.endFrame();
+        const auto rasterEnd = std::chrono::steady_clock::now();
+        recordMs.push_back(std::chrono::duration<double, std::milli>(rasterStart - recordStart).count());
+        rasterMs.push_back(std::chrono::duration<double, std::milli>(rasterEnd - rasterStart).count());
+        commands += renderer.commandCount();
+    }
+
+    double rasterTotal = 0.0;
+    for (double ms : rasterMs) rasterTotal += ms;
+    double recordTotal = 0.0;
+    for (double ms : recordMs) recordTotal += ms;
+    const double frameCount = static_cast<double>(options.renderFrames);
+    const double pixels = static_cast<double>(renderer.width()) * renderer.height();
+    std::cout << std::fixed << std::setprecision(3)
+              << "Render: " << options.renderFrames << " frames " << renderer.width() << "x" << renderer.height()
+              << " on " << renderer.threadCount() << " threads, " << commands / frameCount << " commands/frame\n"
+              << "  record:    mean " << recordTotal / frameCount << " ms, p99 " << percentile(recordMs, 0.99) << " ms\n"
+              << "  rasterize: mean " << rasterTotal / frameCount << " ms, p99 " << percentile(rasterMs, 0.99) << " ms, "
+              << std::setprecision(1) << pixels * frameCount / (rasterTotal * 1000.0) << " Mpixels/s\n";
+
+    if (!options.writeGoldenPath.empty() && !renderer.toImage().saveToFile(options.writeGoldenPath)) {
+        std::cerr << "Render: could not write " << options.writeGoldenPath << "\n";
+        return EXIT_FAILURE;
+    }
+    if (!options.goldenPath.empty()) {
+        sf::Image golden;
+        if (!golden.loadFromFile(options.goldenPath)) {
+            std::cerr << "Render: could not load golden image " << options.goldenPath << "\n";
+            return EXIT_FAILURE;
+        }
+        if (golden.getSize() != sf::Vector2u(renderer.width(), renderer.height())) {
+            std::cerr << "Render: golden image is " << golden.getSize().x << "x" << golden.getSize().y << ", expected "
+                      << renderer.width() << "x" << renderer.height() << "\n";
+            return EXIT_FAILURE;
+        }
+        const std::size_t mismatched = countMismatchedPixels(golden, renderer.pixels());
+        const bool matches = mismatched <= static_cast<std::size_t>(GOLDEN_MAX_MISMATCH * pixels);
+        std::cout << "  golden:    " << mismatched << " pixels differ by more than " << GOLDEN_TOLERANCE << " ("
+                  << (matches ? "match" : "MISMATCH") << ")\n";
+        if (!matches) return EXIT_FAILURE;
+    }
+    return 0;
+}
@@ -0,0 +1,18 @@
+﻿#pragma once
+#include "options.h"
+
+// --- Tryb wsadowy bez okna (--headless K) ---
+// K niezależnych gier rozdzielanych między wątki puli; każda gra ma własne ziarno i sterujący nią skrypt
+// (bot), krok symulacji jest stały, a pętla nie czeka na zegar. Wątki dzielą tylko zasoby do odczytu
+// i licznik następnej gry, więc przepustowość rośnie prawie liniowo z liczbą rdzeni.
+// Zwraca kod wyjścia programu; podsumowanie trafia na std::cout.
+int runHeadless(const LaunchOptions& options);
+
+// --- Pomiar środowiska wsadowego (--batch N) ---
+// N gier w jednym BatchEnv z losowymi akcjami przez options.maxFrames kroków; wypisuje kroki gier na sekundę.
+int runBatch(const LaunchOptions& options);
+
+// --- Rysowanie bez okna (--render-frames N) ---
+// Gra bota (tracker, ziarno --seed) rysowana co krok rasteryzerem CPU; wypisuje czas nagrywania poleceń
+// i rasteryzacji na klatkę. Z --golden kod wyjścia 1, gdy ostatnia klatka różni się od wzorca.
+int runRenderCheck(const LaunchOptions& options);
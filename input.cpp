@@ -0,0 +1,79 @@
+﻿#include "input.h"
+#include <chrono>
+#include <utility>
+
+#if defined(__unix__) && !defined(__APPLE__)
+extern "C" int XInitThreads(); // Z <X11/Xlib.h>; pełny nagłówek koliduje z nazwami SFML
+#endif
+
+sf::Time inputTime() {
+    static const sf::Clock clock;
+    return clock.getElapsedTime();
+}
+
+void initInputThreading() {
+#if defined(__unix__) && !defined(__APPLE__)
+    // SFML dzieli jedno połączenie Xlib między wątki; bez tego isKeyPressed z wątku
+    // próbkującego ściga się z pollEvent w pętli gry.
+    XInitThreads();
+#endif
+    inputTime(); // Start zegara przed pierwszą klatką
+}
+
+InputSampler::InputSampler(std::vector<sf::Keyboard::Key> keys, sf::Time interval)
+    : m_keys(std::move(keys)), m_down(m_keys.size(), 0), m_interval(interval) {}
+
+InputSampler::~InputSampler() {
+    stop();
+}
+
+void InputSampler::setSyntheticKey(sf::Keyboard::Key key, sf::Time period, sf::Time hold) {
+    m_syntheticKey = key;
+    m_syntheticPeriod = period;
+    m_syntheticHold = hold;
+}
+
+void InputSampler::start() {
+    if (m_running.exchange(true)) return;
+    m_thread = std::thread(&InputSampler::run, this);
+}
+
+void InputSampler::stop() {
+    {
+        std::lock_guard<std::mutex> lock(m_pauseMutex);
+        m_running.store(false);
+    }
+    m_pauseChanged.notify_all();
+    if (m_thread.joinable()) m_thread.join();
+}
+
+void InputSampler::setPaused(bool paused) {
+    {
+        std::lock_guard<std::mutex> lock(m_pauseMutex);
+        m_paused.store(paused);
+    }
+    m_pauseChanged.notify_all();
+}
+
+void InputSampler::run() {
+    const auto interval = std::chrono::microseconds(m_interval.asMicroseconds());
+    while (m_running.load(std::memory_order_relaxed)) {
+        if (m_paused.load(std::memory_order_relaxed)) {
+            std::unique_lock<std::mutex> lock(m_pauseMutex);
+            m_pauseChanged.wait(lock, [this] { return !m_paused.load() || !m_running.load(); });
+            continue;
+        }
+        const sf::Time now = inputTime();
+        for (std::size_t i = 0; i < m_keys.size(); ++i) {
+            const bool pressed = (m_keys[i] == m_syntheticKey)
+                ? now.asMicroseconds() % m_syntheticPeriod.asMicroseconds() < m_syntheticHold.asMicroseconds()
+                : sf::Keyboard::isKeyPressed(m_keys[i]);
+            const char down = pressed ? 1 : 0;
+            if (down == m_down[i]) continue;
+            // Przy pełnej kolejce stan zostaje stary, więc zmiana zostanie ponowiona w następnej próbce
+            if (m_queue.push(InputEvent{m_keys[i], down != 0, now})) m_down[i] = down;
+            else m_dropped.fetch_add(1, std::memory_order_relaxed);
+        }
+        std::this_thread::sleep_for(interval);
+    }
+}
@@ -0,0 +1,94 @@
+﻿#pragma once
+#include <SFML/Window.hpp>
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// --- Zegar wejścia ---
+// Wspólna podstawa czasu dla wątku próbkującego i pętli gry (czas od startu programu).
+sf::Time inputTime();
+
+// Musi być wywołane przed utworzeniem okna, jeśli klawiatura jest czytana z innego wątku (X11).
+void initInputThreading();
+
+// --- Zdarzenie wejścia ze znacznikiem czasu ---
+struct InputEvent {
+    sf::Keyboard::Key key;
+    bool pressed;       // true: wciśnięcie, false: puszczenie
+    sf::Time timestamp; // inputTime() w chwili wykrycia
+};
+
+// --- Kolejka SPSC bez blokad ---
+// Jeden producent (wątek próbkujący) i jeden konsument (pętla gry).
+// Pojemność musi być potęgą dwójki; indeksy rosną monotonicznie i są maskowane.
+template <typename T, std::size_t Capacity>
+class SpscQueue {
+    static_assert((Capacity & (Capacity - 1)) == 0, "Capacity musi być potęgą dwójki");
+
+public:
+    bool push(const T& value) {
+        const std::size_t tail = m_tail.load(std::memory_order_relaxed);
+        if (tail - m_head.load(std::memory_order_acquire) == Capacity) return false; // Pełna
+        m_items[tail & (Capacity - 1)] = value;
+        m_tail.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool pop(T& value) {
+        const std::size_t head = m_head.load(std::memory_order_relaxed);
+        if (head == m_tail.load(std::memory_order_acquire)) return false; // Pusta
+        value = m_items[head & (Capacity - 1)];
+        m_head.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+private:
+    std::array<T, Capacity> m_items;
+    alignas(64) std::atomic<std::size_t> m_head{0}; // Osobne linie cache dla producenta i konsumenta
+    alignas(64) std::atomic<std::size_t> m_tail{0};
+};
+
+// --- Wątek próbkujący klawiaturę ---
+// Odpytuje sf::Keyboard::isKeyPressed z wysoką częstotliwością i wysyła do kolejki tylko zmiany stanu,
+// więc pętla gry zna dokładny moment wciśnięcia zamiast granicy klatki.
+class InputSampler {
+public:
+    explicit InputSampler(std::vector<sf::Keyboard::Key> keys, sf::Time interval = sf::microseconds(500));
+    ~InputSampler();
+
+    // Klawisz sterowany zegarem zamiast klawiatury (wciśnięty przez `hold` co `period`), np. dla sondy
+    // opóźnień w CI bez fizycznej klawiatury. Wywołać przed start().
+    void setSyntheticKey(sf::Keyboard::Key key, sf::Time period, sf::Time hold);
+
+    void start();
+    void stop();
+
+    // Wstrzymany wątek czeka na zmiennej warunkowej zamiast odpytywać klawiaturę (okno bez fokusu)
+    void setPaused(bool paused);
+
+    // Wywoływane tylko z pętli gry
+    bool poll(InputEvent& event) { return m_queue.pop(event); }
+
+    std::size_t droppedEvents() const { return m_dropped.load(std::memory_order_relaxed); }
+
+private:
+    void run();
+
+    std::vector<sf::Keyboard::Key> m_keys;
+    std::vector<char> m_down;
+    sf::Time m_interval;
+    sf::Keyboard::Key m_syntheticKey = sf::Keyboard::Unknown;
+    sf::Time m_syntheticPeriod;
+    sf::Time m_syntheticHold;
+    std::atomic<bool> m_running{false};
+    std::atomic<bool> m_paused{false};
+    std::mutex m_pauseMutex;
+    std::condition_variable m_pauseChanged;
+    std::atomic<std::size_t> m_dropped{0};
+    std::thread m_thread;
+    SpscQueue<InputEvent, 256> m_queue;
+};
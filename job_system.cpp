@@ -0,0 +1,93 @@
+﻿#include "job_system.h"
+#include <algorithm>
+#include "trace.h"
+
+namespace {
+// Numer kolejki bieżącego wątku; wątki spoza puli dzielą kolejkę 0
+thread_local std::size_t t_queueIndex = 0;
+} // namespace
+
+JobSystem::JobSystem(unsigned int threads) {
+    if (threads == 0) threads = std::thread::hardware_concurrency();
+    threads = std::max(1u, threads);
+    for (unsigned int i = 0; i < threads; ++i) m_queues.emplace_back(new Queue());
+    for (std::size_t i = 1; i < threads; ++i) m_workers.emplace_back(&JobSystem::workerLoop, this, i);
+}
+
+JobSystem::~JobSystem() {
+    {
+        std::lock_guard<std::mutex> lock(m_sleepMutex);
+        m_stopping = true;
+    }
+    m_wake.notify_all();
+    for (auto& worker : m_workers) worker.join();
+}
+
+void JobSystem::run(Group& group, Job job) {
+    group.m_pending.fetch_add(1, std::memory_order_relaxed);
+    Job counted = [&group, job = std::move(job)]() {
+        job();
+        group.m_pending.fetch_sub(1, std::memory_order_release);
+    };
+    if (m_workers.empty()) {
+        counted();
+        return;
+    }
+    Queue& queue = *m_queues[t_queueIndex];
+    {
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        queue.jobs.push_back(std::move(counted));
+    }
+    m_queued.fetch_add(1, std::memory_order_release);
+    {
+        std::lock_guard<std::mutex> lock(m_sleepMutex); // Bez tego budzenie mogłoby się minąć z zasypianiem
+    }
+    m_wake.notify_one();
+}
+
+void JobSystem::wait(Group& group) {
+    while (group.m_pending.load(std::memory_order_acquire) > 0) {
+        if (!tryRunOne(t_queueIndex)) std::this_thread::yield(); // Reszta grupy trwa na innych wątkach
+    }
+}
+
+bool JobSystem::tryRunOne(std::size_t self) {
+    Job job;
+    if (!popOwn(self, job) && !steal(self, job)) return false;
+    m_queued.fetch_sub(1, std::memory_order_relaxed);
+    job();
+    return true;
+}
+
+bool JobSystem::popOwn(std::size_t self, Job& job) {
+    Queue& queue = *m_queues[self];
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    if (queue.jobs.empty()) return false;
+    job = std::move(queue.jobs.back());
+    queue.jobs.pop_back();
+    return true;
+}
+
+bool JobSystem::steal(std::size_t self, Job& job) {
+    // Ofiary po kolei od następnego wątku, żeby złodzieje nie rzucali się na tę samą kolejkę
+    for (std::size_t i = 1; i < m_queues.size(); ++i) {
+        Queue& queue = *m_queues[(self + i) % m_queues.size()];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        if (queue.jobs.empty()) continue;
+        job = std::move(queue.jobs.front());
+        queue.jobs.pop_front();
+        return true;
+    }
+    return false;
+}
+
+void JobSystem::workerLoop(std::size_t self) {
+    setTraceThreadName("job worker");
+    t_queueIndex = self;
+    for (;;) {
+        if (tryRunOne(self)) continue;
+        std::unique_lock<std::mutex> lock(m_sleepMutex);
+        m_wake.wait(lock, [&]() { return m_stopping || m_queued.load(std::memory_order_acquire) > 0; });
+        if (m_stopping) return;
+    }
+}
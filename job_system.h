@@ -0,0 +1,85 @@
+﻿#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// --- Pula wątków z podkradaniem zadań (work stealing) ---
+// Każdy wątek ma własną kolejkę: nowe zadania trafiają na jej koniec i właściciel bierze je od końca
+// (najświeższe dane w cache), a wątek bez pracy podkrada najstarsze zadanie z początku cudzej kolejki.
+// Wątek czekający na grupę (wait) nie śpi, tylko wykonuje zadania, więc zadania mogą zlecać kolejne.
+// Kolejność wykonania zależy od liczby wątków i przypadku: deterministyczny wynik to sprawa zadań
+// (podział na stałe porcje i scalanie wyników w kolejności porcji, patrz parallelFor).
+class JobSystem {
+public:
+    using Job = std::function<void()>;
+
+    // Zadania zlecone razem; wait() wraca, gdy wszystkie się skończą
+    class Group {
+    public:
+        Group() = default;
+        Group(const Group&) = delete;
+        Group& operator=(const Group&) = delete;
+
+    private:
+        friend class JobSystem;
+        std::atomic<int> m_pending{0};
+    };
+
+    // threads: wątki łącznie z wywołującym (0: tyle, ile rdzeni); 1 = wszystko na wątku wywołującym
+    explicit JobSystem(unsigned int threads);
+    ~JobSystem();
+    JobSystem(const JobSystem&) = delete;
+    JobSystem& operator=(const JobSystem&) = delete;
+
+    unsigned int threadCount() const { return static_cast<unsigned int>(m_workers.size()) + 1; }
+
+    void run(Group& group, Job job);
+    void wait(Group& group);
+
+private:
+    struct Queue {
+        std::mutex mutex;
+        std::deque<Job> jobs;
+    };
+
+    bool tryRunOne(std::size_t self);
+    bool popOwn(std::size_t self, Job& job);
+    bool steal(std::size_t self, Job& job);
+    void workerLoop(std::size_t self);
+
+    std::vector<std::unique_ptr<Queue>> m_queues; // [0]: wątki spoza puli (wywołujący)
+    std::vector<std::thread> m_workers;
+    std::atomic<int> m_queued{0}; // Zadania czekające we wszystkich kolejkach
+    std::mutex m_sleepMutex;
+    std::condition_variable m_wake;
+    bool m_stopping = false;
+};
+
+// Dzieli [0, count) na porcje po chunkSize i wywołuje f(chunk, begin, end) dla każdej porcji.
+// Granice porcji zależą tylko od count i chunkSize, nie od liczby wątków, więc wyniki zapisane
+// per porcja i scalone w kolejności numerów są takie same przy każdej puli. jobs == nullptr albo
+// jedna porcja: wszystko po kolei na wątku wywołującym, bez narzutu zadań.
+inline std::size_t chunkCount(std::size_t count, std::size_t chunkSize) { return (count + chunkSize - 1) / chunkSize; }
+
+template <typename F>
+void parallelFor(JobSystem* jobs, std::size_t count, std::size_t chunkSize, F&& f) {
+    const std::size_t chunks = chunkCount(count, chunkSize);
+    auto runChunk = [&](std::size_t chunk) {
+        const std::size_t begin = chunk * chunkSize;
+        f(chunk, begin, begin + chunkSize < count ? begin + chunkSize : count);
+    };
+    if (!jobs || jobs->threadCount() == 1 || chunks <= 1) {
+        for (std::size_t chunk = 0; chunk < chunks; ++chunk) runChunk(chunk);
+        return;
+    }
+    JobSystem::Group group;
+    for (std::size_t chunk = 1; chunk < chunks; ++chunk) jobs->run(group, [&runChunk, chunk]() { runChunk(chunk); });
+    runChunk(0);
+    jobs->wait(group);
+}
@@ -0,0 +1,72 @@
+﻿#include "latency_probe.h"
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+
+LatencyProbe::LatencyProbe(std::size_t targetSamples)
+    : m_target(targetSamples) {
+    m_samples.reserve(targetSamples);
+}
+
+void LatencyProbe::onSimulated(sf::Time inputTimestamp, sf::Time simulatedAt) {
+    if (!enabled()) return;
+    Sample sample;
+    sample.input = inputTimestamp;
+    sample.simulated = simulatedAt;
+    m_pending.push_back(sample);
+}
+
+void LatencyProbe::onSubmitted(sf::Time submittedAt) {
+    for (auto& sample : m_pending) sample.submitted = submittedAt;
+}
+
+void LatencyProbe::onDisplayed(sf::Time displayedAt) {
+    for (auto& sample : m_pending) {
+        sample.displayed = displayedAt;
+        if (m_samples.size() < m_target) m_samples.push_back(sample);
+    }
+    m_pending.clear();
+}
+
+LatencyProbe::Percentiles LatencyProbe::percentiles(Stage stage) const {
+    Percentiles result = {0.f, 0.f, 0.f, 0.f};
+    if (m_samples.empty()) return result;
+
+    std::vector<float> values;
+    values.reserve(m_samples.size());
+    for (const auto& sample : m_samples) {
+        sf::Time value;
+        switch (stage) {
+            case InputToSimulate:  value = sample.simulated - sample.input; break;
+            case SimulateToSubmit: value = sample.submitted - sample.simulated; break;
+            case SubmitToDisplay:  value = sample.displayed - sample.submitted; break;
+            default:               value = sample.displayed - sample.input; break;
+        }
+        values.push_back(value.asMicroseconds() / 1000.f);
+    }
+    std::sort(values.begin(), values.end());
+
+    // Percentyl metodą najbliższej rangi
+    auto rank = [&](float p) {
+        std::size_t index = static_cast<std::size_t>(std::ceil(p * values.size()));
+        return values[std::min(values.size() - 1, index > 0 ? index - 1 : 0)];
+    };
+    result.p50 = rank(0.50f);
+    result.p90 = rank(0.90f);
+    result.p99 = rank(0.99f);
+    result.max = values.back();
+    return result;
+}
+
+void LatencyProbe::writeReport(std::ostream& out) const {
+    static const char* const names[StageCount] = {"input->simulate", "simulate->submit", "submit->display", "total"};
+    out << "Latency probe: " << m_samples.size() << " samples (ms)\n";
+    out << std::left << std::setw(18) << "stage" << std::right
+        << std::setw(9) << "p50" << std::setw(9) << "p90" << std::setw(9) << "p99" << std::setw(9) << "max" << "\n";
+    out << std::fixed << std::setprecision(3);
+    for (int stage = 0; stage < StageCount; ++stage) {
+        Percentiles p = percentiles(static_cast<Stage>(stage));
+        out << std::left << std::setw(18) << names[stage] << std::right
+            << std::setw(9) << p.p50 << std::setw(9) << p.p90 << std::setw(9) << p.p99 << std::setw(9) << p.max << "\n";
+    }
+}
@@ -0,0 +1,46 @@
+﻿#pragma once
+#include <SFML/System.hpp>
+#include <array>
+#include <cstddef>
+#include <ostream>
+#include <vector>
+
+// --- Sonda opóźnienia wejście → ekran ---
+// Każde wciśnięcie, które dało pocisk, jest śledzone przez etapy klatki:
+//   wejście (znacznik wątku próbkującego) → symulacja (zdarzenie zużyte, pocisk utworzony)
+//   → wysłanie rysowania (ostatni window.draw klatki) → powrót z window.display().
+// Używa wyłącznie zegara CPU (inputTime), więc działa też w oknie na programowym sterowniku GL w CI.
+class LatencyProbe {
+public:
+    enum Stage { InputToSimulate, SimulateToSubmit, SubmitToDisplay, Total, StageCount };
+
+    struct Percentiles {
+        float p50, p90, p99, max; // ms
+    };
+
+    explicit LatencyProbe(std::size_t targetSamples);
+
+    bool enabled() const { return m_target > 0; }
+    bool finished() const { return enabled() && m_samples.size() >= m_target; }
+    std::size_t sampleCount() const { return m_samples.size(); }
+
+    // Wywoływane w kolejności etapów w obrębie jednej klatki
+    void onSimulated(sf::Time inputTimestamp, sf::Time simulatedAt);
+    void onSubmitted(sf::Time submittedAt);
+    void onDisplayed(sf::Time displayedAt);
+
+    Percentiles percentiles(Stage stage) const;
+    void writeReport(std::ostream& out) const;
+
+private:
+    struct Sample {
+        sf::Time input;
+        sf::Time simulated;
+        sf::Time submitted;
+        sf::Time displayed;
+    };
+
+    std::size_t m_target;
+    std::vector<Sample> m_pending; // Wciśnięcia z bieżącej klatki, jeszcze nie na ekranie
+    std::vector<Sample> m_samples;
+};
@@ -1,246 +1,335 @@
 ﻿#include <SFML/Graphics.hpp>
+#include <algorithm>
+#include <array>
 #include <vector>
-#include <list>
+#include <chrono>
 #include <random>
 #include <string>
 #include <cmath>
-#include <ctime>
 #include <iostream> // Dla komunikatów DEBUG
-
-// --- Stałe ---
-const float SCREEN_WIDTH = 800.0f;
-const float SCREEN_HEIGHT = 600.0f;
-const float PLAYER_SPEED = 250.0f;
-const float BULLET_SPEED = 500.0f;
-const float ENEMY_SPEED = 35.0f;
-const float ENEMY_DROP_DISTANCE = 1.0f;
-const float ENEMY_BULLET_SPEED = 250.0f;
-const float ENEMY_SHOOT_INTERVAL = 1.5f;
-const float PLAYER_SHOOT_INTERVAL = 0.4f;
-
-bool moveEnemiesDown = false; // Flaga do przesuwania wrogów w dół
-
-// --- Stany Gry ---
-enum class GameState { MainMenu, Playing, GameOver, LevelWon }; // Dodano MainMenu
-
-// --- Struktura Cząsteczki ---
-struct Particle {
-    sf::CircleShape shape;
-    sf::Vector2f velocity;
-    float lifetime;
+#include "ecs.h"
+#include "game.h"
+#include "headless.h"
+#include "input.h"
+#include "frame_pacer.h"
+#include "job_system.h"
+#include "latency_probe.h"
+#include "options.h"
+#include "perf_overlay.h"
+#include "render.h"
+#include "sfml_backend.h"
+#include "snapshot.h"
+#include "texture_resample.h"
+#include "trace.h"
+#include "versus.h"
+#include <fstream>
+#include <memory>
+
+const unsigned int IDLE_SCREEN_FPS = 20; // Menu i ekrany końcowe bez animowanych cząsteczek
+const char* const QUICKSAVE_FILE = "quicksave.gisnap";
+const char* const AUTOSAVE_FILE = "autosave.gisnap";
+
+// --- Stan wejścia gracza (odtwarzany ze zdarzeń wątku próbkującego) ---
+struct PlayerInput {
+    std::array<bool, sf::Keyboard::KeyCount> keyDown{};
+    sf::Time lastShot; // Chwila ostatniego strzału wg inputTime()
+
+    bool left() const { return keyDown[sf::Keyboard::Left] || keyDown[sf::Keyboard::A]; }
+    bool right() const { return keyDown[sf::Keyboard::Right] || keyDown[sf::Keyboard::D]; }
+    bool fire() const { return keyDown[sf::Keyboard::Space]; }
 };
 
-// --- Funkcja tworzenia eksplozji wroga ---
-void createEnemyExplosion(std::vector<Particle>& particleSystem, sf::Vector2f position) {
-    static std::mt19937 gen(std::random_device{}());
-    std::uniform_real_distribution<> velDist(-60.0f, 60.0f); // Slightly slower particles
-    std::uniform_real_distribution<> lifeDist(0.3f, 0.8f);  // Shorter lifetime
-    std::uniform_int_distribution<> colorCompDist(50, 150); // Grayish/Greenish tones
-
-    int numParticles = 25; // Fewer particles than player explosion
-    for (int i = 0; i < numParticles; ++i) {
-        Particle p;
-        p.shape.setRadius(static_cast<float>(rand() % 2 + 1)); // Smaller particles
-        // Example: Greenish/Grayish color
-        p.shape.setFillColor(sf::Color(colorCompDist(gen) / 2, colorCompDist(gen), colorCompDist(gen) / 2, 200));
-        p.shape.setPosition(position);
-        p.velocity = sf::Vector2f(velDist(gen), velDist(gen));
-        p.lifetime = lifeDist(gen);
-        particleSystem.push_back(p);
+// --- Zastosowanie wejścia w czasie pod-klatkowym ---
+// Zdarzenia są przetwarzane w kolejności znaczników czasu: ruch gracza jest całkowany odcinkami
+// między zdarzeniami, a pocisk powstaje dokładnie w chwili wciśnięcia spacji (lub co PLAYER_SHOOT_INTERVAL
+// przy przytrzymaniu), niezależnie od długości klatki.
+void applyPlayerInput(
+    InputSampler& sampler,
+    PlayerInput& input,
+    Game& game,
+    const GameAssets& assets,
+    sf::Time frameStart,
+    sf::Time frameEnd,
+    LatencyProbe& latencyProbe)
+{
+    TRACE_SCOPE("input");
+    const bool playing = game.state == GameState::Playing;
+    sf::Time cursor = frameStart;
+
+    auto moveFor = [&](float seconds) {
+        float playerMoveX = 0.0f;
+        if (input.left()) playerMoveX -= PLAYER_SPEED * seconds;
+        if (input.right()) playerMoveX += PLAYER_SPEED * seconds;
+        movePlayer(game, playerMoveX);
+    };
+
+    auto fireAt = [&](sf::Time when) {
+        fireBullet(game, assets, (when - frameStart).asSeconds());
+        input.lastShot = when;
+    };
+
+    // Symuluje gracza od cursor do until, z ogniem ciągłym przy przytrzymanej spacji
+    auto advanceTo = [&](sf::Time until) {
+        while (cursor < until) {
+            sf::Time nextShot = std::max(input.lastShot + sf::seconds(PLAYER_SHOOT_INTERVAL), cursor);
+            bool shoot = input.fire() && nextShot <= until;
+            sf::Time segmentEnd = shoot ? nextShot : until;
+            moveFor((segmentEnd - cursor).asSeconds());
+            cursor = segmentEnd;
+            if (shoot) fireAt(cursor);
+        }
+    };
+
+    InputEvent event;
+    while (sampler.poll(event)) {
+        if (playing) advanceTo(std::min(std::max(event.timestamp, cursor), frameEnd));
+        bool wasFiring = input.fire();
+        input.keyDown[event.key] = event.pressed;
+        if (playing && input.fire() && !wasFiring && cursor - input.lastShot >= sf::seconds(PLAYER_SHOOT_INTERVAL)) {
+            fireAt(cursor);
+            latencyProbe.onSimulated(event.timestamp, inputTime());
+        }
     }
+    if (playing) advanceTo(frameEnd);
 }
 
-// --- Funkcja tworzenia eksplozji ---
-void createPlayerExplosion(std::vector<Particle>& particleSystem, sf::Vector2f position) {
-    static std::mt19937 gen(std::random_device{}());
-    std::uniform_real_distribution<> velDist(-90.0f, 90.0f);
-    std::uniform_real_distribution<> lifeDist(0.4f, 1.2f);
-    std::uniform_int_distribution<> colorCompDist(100, 255);
-
-    int numParticles = 40;
-    for (int i = 0; i < numParticles; ++i) {
-        Particle p;
-        p.shape.setRadius(static_cast<float>(rand() % 3 + 1));
-        p.shape.setFillColor(sf::Color(colorCompDist(gen), colorCompDist(gen) / 2, 0, 220));
-        p.shape.setPosition(position);
-        p.velocity = sf::Vector2f(velDist(gen), velDist(gen));
-        p.lifetime = lifeDist(gen);
-        particleSystem.push_back(p);
+// --- Tryb versus z rollbackiem ---
+// Symulacja idzie stałymi krokami VERSUS_STEP z akumulatora czasu, a klawiatura jest czytana raz na krok.
+// Bez --peer obie strony grają na jednej klawiaturze (statek: strzałki i spacja, formacja: A/D i W),
+// każda w osobnej sesji, połączone pętlą z opóźnieniem --loopback-delay klatek.
+int runVersus(sf::RenderWindow& window, FramePacer& framePacer, const LaunchOptions& options,
+              const GameAssets& assets, RenderBackend& renderer) {
+    const VersusSide localSide = options.versusSide == "ship" ? VersusSide::Ship : VersusSide::Formation;
+    const VersusSide otherSide = localSide == VersusSide::Ship ? VersusSide::Formation : VersusSide::Ship;
+    VersusGame start(options.seed); // Obie strony muszą startować z tego samego ziarna (--seed)
+    resetVersus(start, assets);
+
+    std::unique_ptr<Transport> transport;
+    std::unique_ptr<Transport> otherTransport; // Tylko w grze lokalnej
+    if (!options.peer.empty()) {
+        const std::size_t colon = options.peer.rfind(':');
+        const unsigned short peerPort = static_cast<unsigned short>(std::atoi(options.peer.c_str() + colon + 1));
+        std::unique_ptr<UdpTransport> udp(new UdpTransport(options.port, sf::IpAddress(options.peer.substr(0, colon)), peerPort));
+        if (!udp->bound()) {
+            std::cerr << "Versus: could not bind UDP port " << options.port << "\n";
+            return EXIT_FAILURE;
+        }
+        transport = std::move(udp);
+    } else {
+        auto link = LoopbackTransport::createPair(static_cast<std::size_t>(options.loopbackDelay));
+        transport.reset(new LoopbackTransport(link.first));
+        otherTransport.reset(new LoopbackTransport(link.second));
     }
-}
+    RollbackSession session(start, assets, localSide, *transport);
+    std::unique_ptr<RollbackSession> otherSession;
+    if (otherTransport) otherSession.reset(new RollbackSession(start, assets, otherSide, *otherTransport));
+
+    auto readKeys = [&](sf::Keyboard::Key left, sf::Keyboard::Key right, sf::Keyboard::Key fire) {
+        if (!window.hasFocus()) return std::uint8_t(0);
+        std::uint8_t input = 0;
+        if (sf::Keyboard::isKeyPressed(left)) input |= VersusLeft;
+        if (sf::Keyboard::isKeyPressed(right)) input |= VersusRight;
+        if (sf::Keyboard::isKeyPressed(fire)) input |= VersusFire;
+        if (sf::Keyboard::isKeyPressed(sf::Keyboard::R)) input |= VersusRestart;
+        return input;
+    };
+    auto shipKeys = [&]() { return readKeys(sf::Keyboard::Left, sf::Keyboard::Right, sf::Keyboard::Space); };
+    auto formationKeys = [&]() { return readKeys(sf::Keyboard::A, sf::Keyboard::D, sf::Keyboard::W); };
+
+    framePacer.setTarget(60);
+    sf::Clock stepClock;
+    float accumulator = 0.f;
+    while (window.isOpen()) {
+        TRACE_SCOPE("frame");
+        sf::Event event;
+        while (window.pollEvent(event)) {
+            if (event.type == sf::Event::Closed ||
+                (event.type == sf::Event::KeyPressed && event.key.code == sf::Keyboard::Escape)) {
+                window.close();
+            }
+        }
 
-// --- Funkcja Resetowania/Inicjalizacji Gry ---
-void resetGame(
-    GameState& currentState,
-    sf::Sprite& playerSprite,
-    std::list<sf::Sprite>& enemies,
-    std::list<sf::Sprite>& bullets,
-    std::list<sf::Sprite>& enemyBullets,
-    std::vector<Particle>& particles,
-    int& score,
-    sf::Text& scoreText,
-    float& enemyDirection,
-    const sf::Texture& enemyTexture, // Potrzebne do tworzenia wrogów
-    float enemyScaleFactor,         // Skala wrogów
-    float playerScaleFactor)        // Skala gracza (może niepotrzebna jeśli gracz nie jest resetowany w ten sposób)
-{
-    std::cout << "DEBUG: Resetting Game...\n";
-    currentState = GameState::Playing;
-    score = 0;
-    scoreText.setString("Score: 0");
-    scoreText.setCharacterSize(24);
-    scoreText.setFillColor(sf::Color::White);
-    bullets.clear();
-    enemyBullets.clear();
-    enemies.clear();
-    particles.clear();
-
-    // Reset gracza (pozycja i widoczność)
-    sf::FloatRect playerLocalBounds = playerSprite.getLocalBounds(); // Ponownie pobierz localBounds na wszelki wypadek
-    playerSprite.setOrigin(playerLocalBounds.left + playerLocalBounds.width / 2.0f, playerLocalBounds.top + playerLocalBounds.height / 2.0f);
-    playerSprite.setPosition(SCREEN_WIDTH / 2.0f, SCREEN_HEIGHT - playerSprite.getGlobalBounds().height / 2.0f - 10.0f);
-    playerSprite.setColor(sf::Color::White);
-
-    // Stwórz wrogów na nowo
-    int enemiesPerRow = 10;
-    int numRows = 4;
-    sf::Sprite tempEnemySprite(enemyTexture);
-    tempEnemySprite.setScale(enemyScaleFactor, enemyScaleFactor);
-    sf::FloatRect scaledEnemyBounds = tempEnemySprite.getGlobalBounds();
-    float enemySpacingX = scaledEnemyBounds.width * 1.4f;
-    float enemySpacingY = scaledEnemyBounds.height * 1.4f;
-    float startX = (SCREEN_WIDTH - (enemiesPerRow - 1) * enemySpacingX - scaledEnemyBounds.width) / 2.0f;
-    float startY = 60.0f; // Upewnij się, że jest wystarczająco wysoko
-
-    for (int j = 0; j < numRows; ++j) {
-        for (int i = 0; i < enemiesPerRow; ++i) {
-            sf::Sprite enemySprite(enemyTexture);
-            enemySprite.setScale(enemyScaleFactor, enemyScaleFactor);
-            enemySprite.setPosition(startX + i * enemySpacingX, startY + j * enemySpacingY);
-            enemies.push_back(enemySprite);
+        // Stałe kroki; po długiej przerwie (np. przeciąganie okna) nadrabiane najwyżej 0.25 s
+        accumulator += std::min(stepClock.restart().asSeconds(), 0.25f);
+        while (accumulator >= VERSUS_STEP) {
+            accumulator -= VERSUS_STEP;
+            if (otherSession) {
+                session.advance(localSide == VersusSide::Ship ? shipKeys() : formationKeys());
+                otherSession->advance(otherSide == VersusSide::Ship ? shipKeys() : formationKeys());
+            } else {
+                session.advance(shipKeys());
+            }
         }
+
+        // --- Rysowanie stanu lokalnej sesji (z predykcją) ---
+        VersusGame& shown = session.state();
+        renderer.beginFrame(sf::Color(10, 0, 20));
+        renderer.drawFormation(shown.game.formation);
+        drawSprites(renderer, shown.game.world);
+        drawParticles(renderer, shown.game.world);
+
+        const sf::Vector2f center(SCREEN_WIDTH / 2.0f, SCREEN_HEIGHT / 2.0f);
+        if (shown.game.state == GameState::Playing) {
+            const Formation& formation = shown.game.formation;
+            const sf::Vector2f origin(formation.origin);
+            const sf::Vector2f spacing(formation.spacing);
+            renderer.drawRect(sf::FloatRect(origin.x + shown.aimColumn * spacing.x, origin.y - 10.f,
+                                            static_cast<float>(formation.enemySize.x), 4.f), sf::Color::Red);
+            renderer.drawText("Score: " + std::to_string(shown.game.score), sf::Vector2f(10.f, 10.f), 24, sf::Color::White, TextAlign::TopLeft, 1.0f);
+        } else {
+            const bool shipWon = shown.game.state == GameState::LevelWon;
+            renderer.drawText(shipWon ? "SHIP WINS" : "FORMATION WINS", center - sf::Vector2f(0.f, 50.f), 60,
+                              shipWon ? sf::Color::Green : sf::Color::Red, TextAlign::Center, 1.0f);
+            renderer.drawText("Press R to Restart", center + sf::Vector2f(0.f, 40.f), 20, sf::Color::Yellow, TextAlign::Center, 1.0f);
+        }
+        renderer.endFrame();
+        window.display();
+        framePacer.wait();
     }
-    enemyDirection = 1.0f; // Reset kierunku wrogów
+
+    std::cout << "Versus: " << session.frame() << " frames, " << session.rollbacks() << " rollbacks ("
+              << session.resimulatedFrames() << " frames resimulated, max depth " << session.maxRollbackDepth()
+              << "), " << session.stalls() << " stalls\n";
+    return 0;
 }
 
+int main(int argc, char* argv[]) {
+    LaunchOptions options;
+    if (!parseLaunchOptions(argc, argv, options)) return EXIT_FAILURE;
+    TraceSession traceSession(options.tracePath); // Plik powstaje przy wyjściu z main, po zatrzymaniu wątków
+
+    // Tryby bez okna: niezależne gry na puli wątków, gry w lockstepie (środowisko wsadowe), pomiar rollbacku
+    // i skryptów wrogów, rysowanie rasteryzerem CPU
+    if (options.headlessGames > 0) return runHeadless(options);
+    if (options.batchGames > 0) return runBatch(options);
+    if (options.benchRollback) return runRollbackBenchmark(options);
+    if (options.benchScripts > 0) return runScriptBenchmark(options);
+    if (options.renderFrames > 0) return runRenderCheck(options);
 
-int main() {
-    srand(static_cast<unsigned int>(time(0)));
+    initInputThreading();
 
     // --- Inicjalizacja Okna ---
     sf::RenderWindow window(sf::VideoMode(static_cast<unsigned int>(SCREEN_WIDTH), static_cast<unsigned int>(SCREEN_HEIGHT)), "Galaxy Invaders SFML");
-    window.setFramerateLimit(60);
+    FramePacer framePacer(options.targetFps); // Zamiast window.setFramerateLimit (sleep + aktywne czekanie)
+
+    // --- Wątek próbkujący klawiaturę ---
+    InputSampler inputSampler({sf::Keyboard::Left, sf::Keyboard::A, sf::Keyboard::Right, sf::Keyboard::D, sf::Keyboard::Space});
+    PlayerInput playerInput;
+
+    // --- Sonda opóźnień (--latency-probe) ---
+    // Spację "wciska" wątek próbkujący, więc pomiar obejmuje całą ścieżkę zdarzenia, także bez klawiatury w CI.
+    LatencyProbe latencyProbe(static_cast<std::size_t>(std::max(0, options.latencySamples)));
+    if (latencyProbe.enabled()) inputSampler.setSyntheticKey(sf::Keyboard::Space, sf::milliseconds(500), sf::milliseconds(50));
+    inputSampler.start();
 
     // --- Ładowanie Zasobów ---
+    // Obrazy zostają w pamięci CPU na czas budowania masek kolizji
+    GameImages images;
+    if (!loadGameImages(images)) return EXIT_FAILURE;
+
+    // Rozmiary na ekranie i maski kolizji (w skali ekranu, z pełnych obrazów)
+    const GameAssets assets = buildGameAssets(images);
+
+    // Tekstury zmniejszone do rozmiarów na ekranie (patrz texture_resample.h)
+    const float supersample = options.textureSupersample;
     sf::Texture playerTexture;
-    if (!playerTexture.loadFromFile("player.png")) return EXIT_FAILURE;
+    if (!loadSpriteTexture(playerTexture, images.player, sf::Vector2f(assets.playerSize), supersample, options.textureMipmaps)) return EXIT_FAILURE;
     sf::Texture enemyTexture;
-    if (!enemyTexture.loadFromFile("enemy.jpg")) return EXIT_FAILURE;
+    if (!loadSpriteTexture(enemyTexture, images.enemy, sf::Vector2f(assets.enemySize), supersample, options.textureMipmaps)) return EXIT_FAILURE;
     sf::Texture bulletTexture;
-    if (!bulletTexture.loadFromFile("bullet.png")) return EXIT_FAILURE;
+    if (!loadSpriteTexture(bulletTexture, images.bullet, sf::Vector2f(assets.bulletSize), supersample, options.textureMipmaps)) return EXIT_FAILURE;
     sf::Texture enemyBulletTexture;
-    if (!enemyBulletTexture.loadFromFile("enemy_bullet.png")) return EXIT_FAILURE;
+    if (!loadSpriteTexture(enemyBulletTexture, images.enemyBullet, sf::Vector2f(assets.enemyBulletSize), supersample, options.textureMipmaps)) return EXIT_FAILURE;
     sf::Font font;
     // Używaj ścieżki względnej, jeśli plik jest kopiowany przez CMake do katalogu build
     if (!font.loadFromFile("arial.ttf")) {
          // Spróbuj ścieżki z folderem resources, jeśli kopiowanie zawiodło lub uruchamiasz z innego miejsca
         if (!font.loadFromFile("resources/arial.ttf")) return EXIT_FAILURE;
     }
+    const TextureTable textures = {{&playerTexture, &enemyTexture, &bulletTexture, &enemyBulletTexture}};
+    SfmlRenderBackend renderer(window, textures, font);
 
-
-    // --- Ustawienia Skalowania ---
-    const float playerScaleFactor = 0.04f;
-    const float enemyScaleFactor = 0.05f;
-    const float bulletScaleFactor = 0.1f;
-    const float enemyBulletScaleFactor = 0.05f;
+    if (!options.versusSide.empty()) {
+        inputSampler.stop(); // Versus czyta klawiaturę raz na stały krok symulacji
+        return runVersus(window, framePacer, options, assets, renderer);
+    }
 
     // --- Tworzenie Obiektów Gry (początkowe) ---
-    GameState currentState = GameState::MainMenu; // Zacznij od Menu Głównego
-
-    sf::Sprite playerSprite; // Gracz jest tworzony raz
-    playerSprite.setTexture(playerTexture);
-    playerSprite.setScale(playerScaleFactor, playerScaleFactor);
-    // Pozycja gracza jest ustawiana w resetGame()
-
-    std::list<sf::Sprite> bullets;
-    std::list<sf::Sprite> enemyBullets;
-    std::list<sf::Sprite> enemies; // Pusta na początku
-    std::vector<Particle> particles;
-
-    int score = 0; // Wynik jest resetowany w resetGame()
-    float enemyDirection = 1.0f; // Kierunek jest resetowany w resetGame()
-
-    // Teksty
-    sf::Text scoreText("Score: 0", font, 24);
-    scoreText.setPosition(10.f, 10.f);
-    scoreText.setFillColor(sf::Color::White);
-
-    sf::Text titleText("GALAXY INVADERS", font, 60);
-    titleText.setFillColor(sf::Color::Cyan);
-    sf::FloatRect titleBounds = titleText.getLocalBounds();
-    titleText.setOrigin(titleBounds.left + titleBounds.width / 2.0f, titleBounds.top + titleBounds.height / 2.0f);
-    titleText.setPosition(SCREEN_WIDTH / 2.0f, SCREEN_HEIGHT / 2.0f - 100.f);
-
-    sf::Text startText("Press SPACE to Start", font, 30);
-    startText.setFillColor(sf::Color::White);
-    sf::FloatRect startBounds = startText.getLocalBounds();
-    startText.setOrigin(startBounds.left + startBounds.width / 2.0f, startBounds.top + startBounds.height / 2.0f);
-    startText.setPosition(SCREEN_WIDTH / 2.0f, SCREEN_HEIGHT / 2.0f);
-
-    sf::Text gameOverText("GAME OVER", font, 70);
-    gameOverText.setFillColor(sf::Color::Red);
-    sf::FloatRect goTextBounds = gameOverText.getLocalBounds();
-    gameOverText.setOrigin(goTextBounds.left + goTextBounds.width / 2.0f, goTextBounds.top + goTextBounds.height / 2.0f);
-    gameOverText.setPosition(SCREEN_WIDTH / 2.0f, SCREEN_HEIGHT / 2.0f - 50.f);
-
-    sf::Text levelWonText("LEVEL CLEARED!", font, 70);
-    levelWonText.setFillColor(sf::Color::Green);
-    sf::FloatRect lwTextBounds = levelWonText.getLocalBounds();
-    levelWonText.setOrigin(lwTextBounds.left + lwTextBounds.width / 2.0f, lwTextBounds.top + lwTextBounds.height / 2.0f);
-    levelWonText.setPosition(SCREEN_WIDTH / 2.0f, SCREEN_HEIGHT / 2.0f - 50.f);
-
-    sf::Text finalScoreText("", font, 30);
-    finalScoreText.setFillColor(sf::Color::White);
-
-    sf::Text restartText("Press R to Restart", font, 20);
-    restartText.setFillColor(sf::Color::Yellow);
-    sf::FloatRect rTextBounds = restartText.getLocalBounds();
-    restartText.setOrigin(rTextBounds.left + rTextBounds.width / 2.0f, rTextBounds.top + rTextBounds.height / 2.0f);
-    restartText.setPosition(SCREEN_WIDTH / 2.0f, SCREEN_HEIGHT / 2.0f + 40.f);
+    Game game(std::random_device{}()); // Zaczyna w Menu Głównym
+    JobSystem jobs(options.threads);     // Fazy kroku gry (stepGame) równolegle
+    int shownScore = 0; // Wynik widoczny w HUD (animacja przy zmianie)
+
+    // --- Migawki: F5 zapis, F9 powrót, --restore na starcie, --autosave co kilka sekund ---
+    SnapshotWriter snapshotWriter; // Pliki zapisuje wątek w tle
+    std::vector<std::uint8_t> quickSave; // Ostatnia migawka F5, trzymana też w pamięci dla F9
+    std::vector<std::uint8_t> autosaveBuffer;
+    float sinceAutosave = 0.f;
+    if (!options.restorePath.empty()) {
+        if (!readSnapshotFile(options.restorePath, quickSave) || !restoreSnapshot(game, assets, quickSave)) {
+            std::cerr << "Could not restore snapshot from " << options.restorePath << "\n";
+            return EXIT_FAILURE;
+        }
+    }
 
 
     // --- Zmienne i Zegary Gry ---
-    sf::Clock clock;
-    sf::Clock playerShootCooldown;
-    sf::Clock enemyShootTimer;
+    sf::Time frameStart = inputTime(); // Początek przedziału symulowanego w bieżącej klatce
     sf::Clock animationClock;
     sf::Clock scoreAnimationTimer;
 
     bool scoreAnimating = false;
     const float scoreAnimationDuration = 0.2f;
+    bool windowFocused = true;
+    PerfOverlay perfOverlay(font); // F3
+
+    // Start gry z menu i restart po końcu rundy
+    auto startNewGame = [&]() {
+        std::cout << "DEBUG: Resetting Game...\n";
+        resetGame(game, assets);
+        shownScore = 0;
+        scoreAnimating = false;
+        // Zresetuj zegary animacji itp.
+        animationClock.restart();
+        scoreAnimationTimer.restart();
+        playerInput.lastShot = inputTime();
+    };
 
     // --- Główna Pętla Gry ---
     while (window.isOpen()) {
-        float deltaTime = clock.restart().asSeconds();
+        TRACE_SCOPE("frame");
+        const sf::Time frameEnd = inputTime();
+        float deltaTime = (frameEnd - frameStart).asSeconds();
 
         // --- Obsługa Zdarzeń ---
         sf::Event event;
         while (window.pollEvent(event)) {
             if (event.type == sf::Event::Closed) {
                 window.close();
+            } else if (event.type == sf::Event::LostFocus) {
+                windowFocused = false;
+            } else if (event.type == sf::Event::GainedFocus) {
+                windowFocused = true;
+            }
+
+            if (event.type == sf::Event::KeyPressed && event.key.code == sf::Keyboard::F3) {
+                perfOverlay.toggle();
+            } else if (event.type == sf::Event::KeyPressed && event.key.code == sf::Keyboard::F5 && game.state != GameState::MainMenu) {
+                captureSnapshot(game, assets, quickSave);
+                snapshotWriter.save(QUICKSAVE_FILE, quickSave);
+                std::cout << "Snapshot saved (" << quickSave.size() << " bytes)\n";
+            } else if (event.type == sf::Event::KeyPressed && event.key.code == sf::Keyboard::F9 && !quickSave.empty()) {
+                const auto restoreStart = std::chrono::steady_clock::now();
+                if (restoreSnapshot(game, assets, quickSave)) {
+                    const double restoreUs = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - restoreStart).count();
+                    std::cout << "Snapshot restored in " << restoreUs << " us\n";
+                }
             }
 
-            switch (currentState) {
+            switch (game.state) {
                 case GameState::MainMenu:
                     if (event.type == sf::Event::KeyPressed) {
                         if (event.key.code == sf::Keyboard::Space) {
-                            // Wywołaj reset gry przy starcie z menu
-                            resetGame(currentState, playerSprite, enemies, bullets, enemyBullets, particles, score, scoreText, enemyDirection, enemyTexture, enemyScaleFactor, playerScaleFactor);
-                            // Zresetuj zegary animacji itp.
-                            animationClock.restart();
-                            scoreAnimationTimer.restart();
-                            playerShootCooldown.restart();
-                            enemyShootTimer.restart();
+                            startNewGame(); // Wywołaj reset gry przy starcie z menu
                         } else if (event.key.code == sf::Keyboard::Escape) {
                              window.close(); // Wyjście z gry z menu
                         }
@@ -248,249 +337,111 @@ int main() {
                     break;
 
                 case GameState::Playing:
-                    if (event.type == sf::Event::KeyPressed && event.key.code == sf::Keyboard::Space) {
-                        if (playerShootCooldown.getElapsedTime().asSeconds() >= PLAYER_SHOOT_INTERVAL) {
-                            sf::Sprite bulletSprite(bulletTexture);
-                            bulletSprite.setScale(bulletScaleFactor, bulletScaleFactor);
-                            sf::FloatRect scaledBulletBounds = bulletSprite.getGlobalBounds();
-                            sf::Vector2f playerPos = playerSprite.getPosition();
-                            sf::FloatRect currentPlBounds = playerSprite.getGlobalBounds();
-
-                            bulletSprite.setPosition(
-                                playerPos.x - scaledBulletBounds.width / 2.0f,
-                                playerPos.y - currentPlBounds.height / 2.0f - scaledBulletBounds.height
-                            );
-                            bullets.push_back(bulletSprite);
-                            playerShootCooldown.restart();
-                        }
-                    }
-                    break;
+                    break; // Ruch i strzały przychodzą z wątku próbkującego (applyPlayerInput)
 
                 case GameState::GameOver:
                 case GameState::LevelWon:
                     if (event.type == sf::Event::KeyPressed && event.key.code == sf::Keyboard::R) {
-                        // Wywołaj reset gry przy restarcie
-                        resetGame(currentState, playerSprite, enemies, bullets, enemyBullets, particles, score, scoreText, enemyDirection, enemyTexture, enemyScaleFactor, playerScaleFactor);
-                        // Zresetuj zegary animacji itp.
-                        animationClock.restart();
-                        scoreAnimationTimer.restart();
-                        playerShootCooldown.restart();
-                        enemyShootTimer.restart();
+                        startNewGame(); // Wywołaj reset gry przy restarcie
                     }
                     break;
             }
         } // Koniec pętli zdarzeń
 
-
-        // --- Logika Gry (Tylko w stanie Playing) ---
-        if (currentState == GameState::Playing) {
-             // std::cout << "DEBUG: Frame Start - State: Playing\n"; // Odkomentuj do diagnozy
-
-            // Ruch Gracza
-            float playerMoveX = 0.0f;
-            if (sf::Keyboard::isKeyPressed(sf::Keyboard::Left) || sf::Keyboard::isKeyPressed(sf::Keyboard::A)) playerMoveX -= PLAYER_SPEED * deltaTime;
-            if (sf::Keyboard::isKeyPressed(sf::Keyboard::Right) || sf::Keyboard::isKeyPressed(sf::Keyboard::D)) playerMoveX += PLAYER_SPEED * deltaTime;
-            playerSprite.move(playerMoveX, 0.f);
-
-            // Ograniczenie ruchu gracza
-            sf::FloatRect currentPlBounds = playerSprite.getGlobalBounds();
-            if (currentPlBounds.left < 0.f) playerSprite.setPosition(currentPlBounds.width / 2.0f, playerSprite.getPosition().y);
-            if (currentPlBounds.left + currentPlBounds.width > SCREEN_WIDTH) playerSprite.setPosition(SCREEN_WIDTH - currentPlBounds.width / 2.0f, playerSprite.getPosition().y);
-
-            // Ruch Pocisków Gracza
-            for (auto it = bullets.begin(); it != bullets.end();) {
-                it->move(0.f, -BULLET_SPEED * deltaTime);
-                if (it->getPosition().y + it->getGlobalBounds().height < 0) it = bullets.erase(it);
-                else ++it;
+        // --- Oszczędzanie energii: bez fokusu gra stoi, a wątek główny śpi w waitEvent ---
+        // (Poza sondą opóźnień: w CI okno często w ogóle nie dostaje fokusu.)
+        if (!windowFocused && !latencyProbe.enabled()) {
+            inputSampler.setPaused(true);
+            while (window.isOpen() && !windowFocused && window.waitEvent(event)) {
+                if (event.type == sf::Event::Closed) window.close();
+                else if (event.type == sf::Event::GainedFocus) windowFocused = true;
             }
+            inputSampler.setPaused(false);
+            frameStart = inputTime(); // Czas bez fokusu nie trafia do deltaTime
+            continue;
+        }
 
-            // Ruch Wrogów i Sprawdzanie Krawędzi/Dna
-            moveEnemiesDown = false;
-            // std::cout << "DEBUG: Checking Enemy Edge/Bottom...\n"; // Odkomentuj do diagnozy
-            for (const auto& enemy : enemies) {
-                sf::FloatRect enemyBounds = enemy.getGlobalBounds();
-                // Sprawdzenie krawędzi
-                if ((enemyDirection > 0 && enemyBounds.left + enemyBounds.width >= SCREEN_WIDTH - 5.f) ||
-                    (enemyDirection < 0 && enemyBounds.left <= 5.f)) {
-                    enemyDirection *= -1.0f;
-                    moveEnemiesDown = true;
-                    break; // Wystarczy jeden wróg na krawędzi
-                }
-                // Sprawdzenie czy wróg dotarł do dna (Game Over)
-                // Spróbuj tego warunku, jeśli poprzedni był zbyt czuły:
-                if (enemyBounds.top + enemyBounds.height >= SCREEN_HEIGHT - 50.f) { // Sprawdza czy wróg jest blisko samego dołu
-                // Poprzedni warunek: if (enemyBounds.top + enemyBounds.height >= SCREEN_HEIGHT - playerSprite.getGlobalBounds().height - 20.f) {
-                    // std::cout << "!!!! DEBUG: ENEMY REACHED BOTTOM DETECTED !!!! Y=" << enemyBounds.top + enemyBounds.height << "\n"; // Odkomentuj
-                    currentState = GameState::GameOver;
-                    createPlayerExplosion(particles, playerSprite.getPosition());
-                    playerSprite.setColor(sf::Color::Transparent);
-                    goto end_playing_logic; // Użyj goto, aby pominąć resztę logiki
-                }
-            }
-            // Przesuń wszystkich wrogów
-            for (auto& enemy : enemies) enemy.move(ENEMY_SPEED * enemyDirection * deltaTime, (moveEnemiesDown ? ENEMY_DROP_DISTANCE : 0.f));
-
-            // Strzelanie Wrogów
-            if (enemyShootTimer.getElapsedTime().asSeconds() >= ENEMY_SHOOT_INTERVAL && !enemies.empty()) {
-                int randomIndex = rand() % enemies.size();
-                auto it = std::next(enemies.begin(), randomIndex);
-                if (it != enemies.end()) {
-                    sf::Sprite enemyBulletSprite(enemyBulletTexture);
-                    enemyBulletSprite.setScale(enemyBulletScaleFactor, enemyBulletScaleFactor);
-                    sf::FloatRect scaledBulletBounds = enemyBulletSprite.getGlobalBounds();
-                    sf::FloatRect enemyBounds = it->getGlobalBounds();
-                    enemyBulletSprite.setPosition(
-                        enemyBounds.left + enemyBounds.width / 2.0f - scaledBulletBounds.width / 2.0f,
-                        enemyBounds.top + enemyBounds.height);
-                    enemyBullets.push_back(enemyBulletSprite);
-                    enemyShootTimer.restart();
-                }
-            }
+        // Sonda opóźnień: gra startuje i restartuje się sama, po zebraniu próbek okno się zamyka
+        if (latencyProbe.enabled()) {
+            if (latencyProbe.finished()) window.close();
+            else if (game.state != GameState::Playing) startNewGame();
+        }
 
-            // Ruch Pocisków Wrogów i Kolizja z Graczem
-            for (auto it = enemyBullets.begin(); it != enemyBullets.end();) {
-                it->move(0.f, ENEMY_BULLET_SPEED * deltaTime);
-                bool erased = false;
-                if (it->getPosition().y > SCREEN_HEIGHT) {
-                    it = enemyBullets.erase(it);
-                    erased = true;
-                } else if (it->getGlobalBounds().intersects(playerSprite.getGlobalBounds())) {
-                    // std::cout << "!!!! DEBUG: PLAYER HIT BY ENEMY BULLET DETECTED !!!!\n"; // Odkomentuj
-                    currentState = GameState::GameOver;
-                    createPlayerExplosion(particles, playerSprite.getPosition());
-                    playerSprite.setColor(sf::Color::Transparent);
-                    it = enemyBullets.erase(it);
-                    erased = true;
-                    goto end_playing_logic; // Pomiń resztę logiki
-                }
-                if (!erased) ++it;
+        // Ruch gracza i strzały ze znacznikami czasu z wątku próbkującego
+        const auto simulateStart = std::chrono::steady_clock::now();
+        applyPlayerInput(inputSampler, playerInput, game, assets, frameStart, frameEnd, latencyProbe);
+        frameStart = frameEnd;
+
+        // --- Logika Gry, cząsteczki i odroczone spawny/usunięcia ---
+        stepGame(game, assets, deltaTime, &jobs);
+        const auto simulateEnd = std::chrono::steady_clock::now();
+
+        if (options.autosaveSeconds > 0.f && game.state == GameState::Playing) {
+            sinceAutosave += deltaTime;
+            if (sinceAutosave >= options.autosaveSeconds) {
+                captureSnapshot(game, assets, autosaveBuffer);
+                snapshotWriter.save(AUTOSAVE_FILE, autosaveBuffer);
+                sinceAutosave = 0.f;
             }
+        }
 
-            // Kolizje Pocisków Gracza z Wrogami
-            for (auto bulletIt = bullets.begin(); bulletIt != bullets.end();) {
-                bool bulletRemoved = false;
-                // std::cout << "DEBUG: Checking PlayerBullet-Enemy Collision...\n"; // Odkomentuj
-                for (auto enemyIt = enemies.begin(); enemyIt != enemies.end();) {
-                    if (bulletIt->getGlobalBounds().intersects(enemyIt->getGlobalBounds())) {
-                        // std::cout << "DEBUG: PenemyItlayerBullet-Enemy Collision DETECTED!\n"; // Odkomentuj
-                        // --- ADD EXPLOSION CALL HERE ---
-                        sf::FloatRect enemyBounds = enemyIt->getGlobalBounds();
-                        createEnemyExplosion(particles, sf::Vector2f(enemyBounds.left + enemyBounds.width / 2.f, enemyBounds.top + enemyBounds.height / 2.f));
-                        // --- END OF ADDED CODE ---
-                        enemyIt = enemies.erase(enemyIt);
-                        bulletIt = bullets.erase(bulletIt);
-                        bulletRemoved = true;
-                        score += 10;
-                        scoreText.setString("Score: " + std::to_string(score));
-                        scoreAnimating = true;
-                        scoreAnimationTimer.restart();
-                        scoreText.setCharacterSize(30);
-                        scoreText.setFillColor(sf::Color::Yellow);
-                        goto next_bullet; // Przejdź do następnej iteracji pętli pocisków
-                    } else {
-                        ++enemyIt;
-                    }
-                }
-                next_bullet:; // Etykieta dla goto
-                if (!bulletRemoved) ++bulletIt; // Tylko jeśli pocisk nie został usunięty
-                else if (bulletIt == bullets.end()) break; // Jeśli usunięto ostatni pocisk
-            }
+        // Animacja wyniku po trafieniu
+        if (game.score != shownScore) {
+            shownScore = game.score;
+            scoreAnimating = true;
+            scoreAnimationTimer.restart();
+        }
+        // Koniec animacji wyniku
+        if (scoreAnimating && scoreAnimationTimer.getElapsedTime().asSeconds() >= scoreAnimationDuration) {
+            scoreAnimating = false;
+        }
 
+        // --- Rysowanie (ta sama klatka co w rasteryzerze CPU, patrz render.h) ---
+        const auto renderStart = std::chrono::steady_clock::now();
+        drawGameFrame(renderer, game, HudState{shownScore, scoreAnimating, animationClock.getElapsedTime().asSeconds()});
+        renderer.endFrame();
+        if (perfOverlay.visible()) {
+            const auto renderEnd = std::chrono::steady_clock::now();
+            const PerfSample sample{deltaTime * 1000.f,
+                                    std::chrono::duration<float, std::milli>(simulateEnd - simulateStart).count(),
+                                    std::chrono::duration<float, std::milli>(renderEnd - renderStart).count(),
+                                    renderer.drawCalls(), renderer.vertexCount()};
+            perfOverlay.addFrame(sample, countEntities(game));
+            perfOverlay.draw(window); // Poza buforem poleceń, więc nie zmienia liczników gry
+        }
+        latencyProbe.onSubmitted(inputTime());
 
-            // Kolizje Gracza z Wrogami
-            // std::cout << "DEBUG: Checking Player-Enemy Collision...\n"; // Odkomentuj
-            for (const auto& enemy : enemies) {
-                if (playerSprite.getGlobalBounds().intersects(enemy.getGlobalBounds())) {
-                    // std::cout << "!!!! DEBUG: PLAYER-ENEMY COLLISION DETECTED !!!!\n"; // Odkomentuj
-                    currentState = GameState::GameOver;
-                    createPlayerExplosion(particles, playerSprite.getPosition());
-                    playerSprite.setColor(sf::Color::Transparent);
-                    goto end_playing_logic; // Pomiń resztę logiki
-                }
-            }
+        {
+            TRACE_SCOPE("display");
+            window.display();
+        }
+        latencyProbe.onDisplayed(inputTime());
 
-            // Sprawdzenie warunku wygranej
-            if (enemies.empty()) {
-                currentState = GameState::LevelWon;
-                // Można dodać efekt dźwiękowy lub wizualny wygranej
-            }
+        // Statyczne ekrany bez cząsteczek nie potrzebują pełnego tempa klatek
+        bool staticScreen = game.state != GameState::Playing && game.world.count<Lifetime>() == 0;
+        unsigned int wantedFps = staticScreen ? IDLE_SCREEN_FPS : options.targetFps;
+        if (framePacer.target() != wantedFps) framePacer.setTarget(wantedFps);
+        framePacer.wait();
+    } // Koniec głównej pętli
 
-            // Koniec animacji wyniku
-            if (scoreAnimating && scoreAnimationTimer.getElapsedTime().asSeconds() >= scoreAnimationDuration) {
-                scoreAnimating = false;
-                scoreText.setCharacterSize(24);
-                scoreText.setFillColor(sf::Color::White);
-            }
+    if (options.pacingStats) framePacer.writeStats(std::cout);
 
-        } // Koniec if (currentState == GameState::Playing)
-        end_playing_logic:; // Etykieta dla goto
-
-        // --- Aktualizacja Cząsteczek (Zawsze) ---
-        for (auto it = particles.begin(); it != particles.end();) {
-            it->lifetime -= deltaTime;
-            if (it->lifetime <= 0) it = particles.erase(it);
-            else {
-                it->shape.move(it->velocity * deltaTime);
-                float alphaRatio = std::max(0.f, it->lifetime / 1.2f);
-                sf::Color color = it->shape.getFillColor();
-                color.a = static_cast<sf::Uint8>(200 * alphaRatio);
-                it->shape.setFillColor(color);
-                ++it;
-            }
+    if (latencyProbe.enabled()) {
+        latencyProbe.writeReport(std::cout);
+        if (!options.latencyReport.empty()) {
+            std::ofstream report(options.latencyReport);
+            latencyProbe.writeReport(report);
         }
-
-        // --- Rysowanie ---
-        window.clear(sf::Color(10, 0, 20)); // Ciemniejsze tło
-
-        // Rysowanie zależne od stanu
-        switch (currentState) {
-             case GameState::MainMenu:
-                { // Pulsowanie tekstu startowego
-                    float time = animationClock.getElapsedTime().asSeconds();
-                    float scaleFactor = 1.0f + 0.05f * sin(time * 4.0f);
-                    startText.setScale(scaleFactor, scaleFactor);
-                    window.draw(titleText);
-                    window.draw(startText);
-                    startText.setScale(1.0f, 1.0f); // Reset skali
-                }
-                break;
-
-            case GameState::Playing:
-                if(playerSprite.getColor() != sf::Color::Transparent) // Rysuj gracza tylko jeśli jest widoczny
-                    window.draw(playerSprite);
-                for (const auto& enemy : enemies) window.draw(enemy);
-                for (const auto& bullet : bullets) window.draw(bullet);
-                for (const auto& bullet : enemyBullets) window.draw(bullet);
-                window.draw(scoreText);
-                break;
-
-            case GameState::GameOver:
-            case GameState::LevelWon: // Wspólne rysowanie dla obu końcowych stanów
-                {
-                    sf::Text* mainText = (currentState == GameState::GameOver) ? &gameOverText : &levelWonText;
-                    float time = animationClock.getElapsedTime().asSeconds();
-                    float scaleFactor = 1.0f + 0.05f * sin(time * 5.0f);
-                    mainText->setScale(scaleFactor, scaleFactor);
-                    window.draw(*mainText);
-                    mainText->setScale(1.0f, 1.0f);
-
-                    finalScoreText.setString("Final Score: " + std::to_string(score));
-                    sf::FloatRect fsBounds = finalScoreText.getLocalBounds();
-                    finalScoreText.setOrigin(fsBounds.left + fsBounds.width / 2.0f, fsBounds.top + fsBounds.height / 2.0f);
-                    finalScoreText.setPosition(SCREEN_WIDTH / 2.0f, SCREEN_HEIGHT / 2.0f);
-                    window.draw(finalScoreText);
-                    window.draw(restartText);
-                }
-                break;
+        if (latencyProbe.sampleCount() < static_cast<std::size_t>(options.latencySamples)) {
+            std::cerr << "Latency probe: window closed before all samples were collected\n";
+            return EXIT_FAILURE;
         }
-
-        // Rysuj cząsteczki na wierzchu (zawsze)
-        for (const auto& p : particles) {
-            window.draw(p.shape);
+        float p99 = latencyProbe.percentiles(LatencyProbe::Total).p99;
+        if (options.latencyBudgetMs > 0.f && p99 > options.latencyBudgetMs) {
+            std::cerr << "Latency probe: p99 " << p99 << " ms exceeds budget " << options.latencyBudgetMs << " ms\n";
+            return EXIT_FAILURE;
         }
-
-        window.display();
-    } // Koniec głównej pętli
+    }
 
     return 0;
-}
\ No newline at end of file
+}
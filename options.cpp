@@ -0,0 +1,145 @@
+﻿#include "options.h"
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+
+namespace {
+void printUsage(const char* program) {
+    std::cerr << "Usage: " << program << " [options]\n"
+              << "  --fps N|uncapped         frame rate target (60, 120, 144, ...; 0 or uncapped = no limit)\n"
+              << "  --pacing-stats           print frame-interval jitter on exit\n"
+              << "  --latency-probe N        measure input-to-display latency over N shots, then exit\n"
+              << "  --latency-budget-ms X    exit with code 1 if p99 total latency exceeds X ms\n"
+              << "  --latency-report FILE    also write the latency report to FILE\n"
+              << "  --restore FILE           start from a saved snapshot (F5 quicksaves, F9 restores)\n"
+              << "  --autosave SEC           save a snapshot to autosave.gisnap every SEC seconds of play\n"
+              << "  --headless K             run K games without a window as fast as possible, then exit\n"
+              << "  --threads T              worker threads for --headless, --render-frames and the window's game step (default: all cores)\n"
+              << "  --seed S                 base seed for --headless games (default 1)\n"
+              << "  --frames N               step limit per headless game (default 36000)\n"
+              << "  --bot tracker|random     input script for headless games (default tracker)\n"
+              << "  --results FILE           write per-game headless results as CSV to FILE\n"
+              << "  --batch N                step N games in lockstep with random actions for --frames steps\n"
+              << "  --versus ship|formation  two-player versus mode, playing the given side\n"
+              << "  --peer HOST:PORT         versus opponent over UDP (default: both sides local, over loopback)\n"
+              << "  --port N                 local UDP port for versus (default 47000)\n"
+              << "  --loopback-delay N       simulated input delay in frames for local versus (default 4)\n"
+              << "  --bench-rollback         time 8-frame rollbacks for --frames frames, then exit\n"
+              << "  --bench-scripts N        time coroutine resumes of 2N scripted enemies for --frames steps, then exit\n"
+              << "  --render-frames N        render N frames of a bot game with the CPU rasterizer, then exit\n"
+              << "  --golden FILE            compare the last rendered frame with the image in FILE\n"
+              << "  --write-golden FILE      save the last rendered frame to FILE\n"
+              << "  --texture-supersample X  upload sprite textures at X times their on-screen size (default 2, 0 = full-size images)\n"
+              << "  --mipmaps                generate mipmaps for the sprite textures\n"
+              << "  --trace FILE             record frame phases and write a Chrome trace (Perfetto) JSON to FILE on exit\n";
+}
+} // namespace
+
+bool parseLaunchOptions(int argc, char* argv[], LaunchOptions& options) {
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        auto nextValue = [&](const char*& value) {
+            if (i + 1 >= argc) {
+                std::cerr << "Missing value for " << arg << "\n";
+                return false;
+            }
+            value = argv[++i];
+            return true;
+        };
+
+        const char* value = nullptr;
+        if (arg == "--fps") {
+            if (!nextValue(value)) return false;
+            options.targetFps = std::string(value) == "uncapped" ? 0u : static_cast<unsigned int>(std::atoi(value));
+        } else if (arg == "--pacing-stats") {
+            options.pacingStats = true;
+        } else if (arg == "--latency-probe") {
+            if (!nextValue(value)) return false;
+            options.latencySamples = std::atoi(value);
+        } else if (arg == "--latency-budget-ms") {
+            if (!nextValue(value)) return false;
+            options.latencyBudgetMs = static_cast<float>(std::atof(value));
+        } else if (arg == "--latency-report") {
+            if (!nextValue(value)) return false;
+            options.latencyReport = value;
+        } else if (arg == "--restore") {
+            if (!nextValue(value)) return false;
+            options.restorePath = value;
+        } else if (arg == "--autosave") {
+            if (!nextValue(value)) return false;
+            options.autosaveSeconds = static_cast<float>(std::atof(value));
+        } else if (arg == "--headless") {
+            if (!nextValue(value)) return false;
+            options.headlessGames = std::atoi(value);
+        } else if (arg == "--threads") {
+            if (!nextValue(value)) return false;
+            options.threads = static_cast<unsigned int>(std::atoi(value));
+        } else if (arg == "--seed") {
+            if (!nextValue(value)) return false;
+            options.seed = static_cast<std::uint32_t>(std::strtoul(value, nullptr, 10));
+        } else if (arg == "--frames") {
+            if (!nextValue(value)) return false;
+            options.maxFrames = std::strtoul(value, nullptr, 10);
+        } else if (arg == "--bot") {
+            if (!nextValue(value)) return false;
+            options.bot = value;
+            if (options.bot != "tracker" && options.bot != "random") {
+                std::cerr << "Unknown bot: " << options.bot << " (expected tracker or random)\n";
+                return false;
+            }
+        } else if (arg == "--batch") {
+            if (!nextValue(value)) return false;
+            options.batchGames = std::atoi(value);
+        } else if (arg == "--versus") {
+            if (!nextValue(value)) return false;
+            options.versusSide = value;
+            if (options.versusSide != "ship" && options.versusSide != "formation") {
+                std::cerr << "Unknown versus side: " << options.versusSide << " (expected ship or formation)\n";
+                return false;
+            }
+        } else if (arg == "--peer") {
+            if (!nextValue(value)) return false;
+            options.peer = value;
+            if (options.peer.find(':') == std::string::npos) {
+                std::cerr << "Expected HOST:PORT for --peer, got " << options.peer << "\n";
+                return false;
+            }
+        } else if (arg == "--port") {
+            if (!nextValue(value)) return false;
+            options.port = static_cast<unsigned short>(std::atoi(value));
+        } else if (arg == "--loopback-delay") {
+            if (!nextValue(value)) return false;
+            options.loopbackDelay = std::max(0, std::atoi(value));
+        } else if (arg == "--bench-rollback") {
+            options.benchRollback = true;
+        } else if (arg == "--bench-scripts") {
+            if (!nextValue(value)) return false;
+            options.benchScripts = std::max(0, std::atoi(value));
+        } else if (arg == "--render-frames") {
+            if (!nextValue(value)) return false;
+            options.renderFrames = std::atoi(value);
+        } else if (arg == "--golden") {
+            if (!nextValue(value)) return false;
+            options.goldenPath = value;
+        } else if (arg == "--write-golden") {
+            if (!nextValue(value)) return false;
+            options.writeGoldenPath = value;
+        } else if (arg == "--texture-supersample") {
+            if (!nextValue(value)) return false;
+            options.textureSupersample = static_cast<float>(std::atof(value));
+        } else if (arg == "--mipmaps") {
+            options.textureMipmaps = true;
+        } else if (arg == "--trace") {
+            if (!nextValue(value)) return false;
+            options.tracePath = value;
+        } else if (arg == "--results") {
+            if (!nextValue(value)) return false;
+            options.results = value;
+        } else {
+            std::cerr << "Unknown option: " << arg << "\n";
+            printUsage(argv[0]);
+            return false;
+        }
+    }
+    return true;
+}
@@ -0,0 +1,58 @@
+﻿#pragma once
+#include <cstdint>
+#include <string>
+
+// --- Opcje uruchomienia (linia poleceń) ---
+struct LaunchOptions {
+    // Tempo klatek: --fps 60|120|144|uncapped (0 = bez limitu), --pacing-stats wypisuje jitter przy wyjściu
+    unsigned int targetFps = 60;
+    bool pacingStats = false;
+
+    // Sonda opóźnień wejście → ekran: --latency-probe N [--latency-budget-ms X] [--latency-report plik]
+    int latencySamples = 0;
+    float latencyBudgetMs = 0.f; // > 0: kod wyjścia 1, gdy p99 całkowitego opóźnienia przekroczy budżet
+    std::string latencyReport;
+
+    // Tryb wsadowy bez okna: --headless K [--threads T] [--seed S] [--frames N] [--bot tracker|random] [--results plik.csv]
+    int headlessGames = 0;
+    unsigned int threads = 0;        // 0: tyle wątków, ile rdzeni
+    std::uint32_t seed = 1;          // Gra i dostaje ziarno wyprowadzone z (seed, i)
+    unsigned long maxFrames = 36000; // Limit kroków na grę (10 minut gry przy 60 Hz)
+    std::string bot = "tracker";
+    std::string results;             // CSV z wynikiem każdej gry
+
+    // Migawki stanu gry: --restore plik wczytuje migawkę na starcie, --autosave S zapisuje ją co S sekund gry
+    std::string restorePath;
+    float autosaveSeconds = 0.f;
+
+    // Środowisko wsadowe: --batch N gier w lockstepie z losowymi akcjami przez --frames kroków (pomiar kroków/s)
+    int batchGames = 0;
+
+    // Versus z rollbackiem: --versus ship|formation; bez --peer obie strony grają lokalnie przez pętlę
+    // z opóźnieniem --loopback-delay klatek, z --peer HOST:PORT przez UDP (port lokalny --port)
+    std::string versusSide;
+    std::string peer;
+    unsigned short port = 47000;
+    int loopbackDelay = 4;
+    bool benchRollback = false; // Pomiar rollbacku o 8 klatek przez --frames klatek, bez okna
+
+    // Pomiar skryptów wrogów: --bench-scripts N wznawia N skryptów co krok i N na timerach przez --frames kroków
+    int benchScripts = 0;
+
+    // Rysowanie bez okna: --render-frames N klatek gry bota rasteryzerem CPU (--threads wątków);
+    // --write-golden zapisuje ostatnią klatkę, --golden porównuje ją z zapisanym obrazem
+    int renderFrames = 0;
+    std::string goldenPath;
+    std::string writeGoldenPath;
+
+    // Tekstury sprite'ów zmniejszone przy ładowaniu do rozmiaru na ekranie razy --texture-supersample
+    // (0: pełne obrazy źródłowe), --mipmaps dodaje mipmapy
+    float textureSupersample = 2.f;
+    bool textureMipmaps = false;
+
+    // Oś czasu faz klatki i wątków w formacie Chrome trace: --trace plik.json (zapis przy wyjściu)
+    std::string tracePath;
+};
+
+// Zwraca false przy nieznanej opcji lub brakującej wartości (opis błędu trafia na std::cerr)
+bool parseLaunchOptions(int argc, char* argv[], LaunchOptions& options);
@@ -0,0 +1,117 @@
+﻿#include "perf_overlay.h"
+#include <algorithm>
+#include <cstdio>
+
+namespace {
+const float TEXT_REFRESH = 0.25f;    // Sekundy między składaniem tekstu
+const float BAR_WIDTH = 2.f;
+const float PADDING = 8.f;
+const float GRAPH_HEIGHT = 60.f;
+const float GRAPH_MAX_MS = 1000.f / 30.f; // Górna krawędź wykresu; dłuższe klatki są przycinane
+const float BUDGET_MS = 1000.f / 60.f;
+const float TEXT_HEIGHT = 80.f;      // 5 wierszy po 12 px z odstępem
+const unsigned int TEXT_SIZE = 12;
+const float PANEL_WIDTH = PerfOverlay::HISTORY * BAR_WIDTH + 2 * PADDING;
+const float PANEL_LEFT = SCREEN_WIDTH - PANEL_WIDTH - 10.f;
+const float PANEL_TOP = 10.f;
+
+const sf::Color PANEL_COLOR(0, 0, 0, 170);
+const sf::Color BUDGET_COLOR(255, 255, 255, 120);
+const sf::Color SIMULATE_COLOR(80, 160, 255);
+const sf::Color RENDER_COLOR(255, 170, 60);
+const sf::Color OTHER_COLOR(120, 120, 120); // Display, czekanie na tempo klatek, zdarzenia
+
+void appendQuad(sf::VertexArray& vertices, float left, float top, float width, float height, sf::Color color) {
+    vertices.append(sf::Vertex(sf::Vector2f(left, top), color));
+    vertices.append(sf::Vertex(sf::Vector2f(left + width, top), color));
+    vertices.append(sf::Vertex(sf::Vector2f(left + width, top + height), color));
+    vertices.append(sf::Vertex(sf::Vector2f(left, top + height), color));
+}
+} // namespace
+
+EntityCounts countEntities(Game& game) {
+    EntityCounts counts{game.formation.aliveCount, 0, 0, static_cast<int>(game.world.count<Lifetime>())};
+    game.world.each<Velocity, Renderable, Team>([&](Entity, Velocity&, Renderable& look, Team& team) {
+        if (isDiver(look, team)) ++counts.enemies; // Nurkujący poza formacją
+        else if (team == Team::Player) ++counts.bullets;
+        else ++counts.enemyBullets;
+    });
+    return counts;
+}
+
+PerfOverlay::PerfOverlay(const sf::Font& font) : m_graph(sf::Quads), m_text("", font, TEXT_SIZE) {
+    m_text.setPosition(PANEL_LEFT + PADDING, PANEL_TOP + 2 * PADDING + GRAPH_HEIGHT);
+}
+
+void PerfOverlay::addFrame(const PerfSample& sample, const EntityCounts& counts) {
+    if (!m_visible) return;
+    const auto start = std::chrono::steady_clock::now();
+    m_samples[m_next] = sample;
+    m_next = (m_next + 1) % HISTORY;
+    m_filled = std::min(m_filled + 1, HISTORY);
+    m_counts = counts;
+    rebuildGraph();
+    m_sinceText += sample.frameMs / 1000.f;
+    if (m_sinceText >= TEXT_REFRESH || m_filled == 1) {
+        refreshText();
+        m_sinceText = 0.f;
+    }
+    m_overlayMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+void PerfOverlay::draw(sf::RenderTarget& target) {
+    if (!m_visible) return;
+    const auto start = std::chrono::steady_clock::now();
+    target.draw(m_graph);
+    target.draw(m_text);
+    m_overlayMs += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+void PerfOverlay::rebuildGraph() {
+    m_graph.clear();
+    appendQuad(m_graph, PANEL_LEFT, PANEL_TOP, PANEL_WIDTH, 3 * PADDING + GRAPH_HEIGHT + TEXT_HEIGHT, PANEL_COLOR);
+
+    // Słupki od najstarszej próbki: symulacja od dołu, nad nią rysowanie, reszta klatki na szaro
+    const float pixelsPerMs = GRAPH_HEIGHT / GRAPH_MAX_MS;
+    const float bottom = PANEL_TOP + PADDING + GRAPH_HEIGHT;
+    for (std::size_t i = 0; i < m_filled; ++i) {
+        const PerfSample& s = m_samples[(m_next + HISTORY - m_filled + i) % HISTORY];
+        const float left = PANEL_LEFT + PADDING + (HISTORY - m_filled + i) * BAR_WIDTH;
+        const float frame = std::min(s.frameMs, GRAPH_MAX_MS) * pixelsPerMs;
+        const float simulate = std::min(s.simulateMs * pixelsPerMs, frame);
+        const float render = std::min(s.renderMs * pixelsPerMs, frame - simulate);
+        appendQuad(m_graph, left, bottom - simulate, BAR_WIDTH, simulate, SIMULATE_COLOR);
+        appendQuad(m_graph, left, bottom - simulate - render, BAR_WIDTH, render, RENDER_COLOR);
+        appendQuad(m_graph, left, bottom - frame, BAR_WIDTH, frame - simulate - render, OTHER_COLOR);
+    }
+    appendQuad(m_graph, PANEL_LEFT + PADDING, bottom - BUDGET_MS * pixelsPerMs, HISTORY * BAR_WIDTH, 1.f, BUDGET_COLOR);
+}
+
+void PerfOverlay::refreshText() {
+    float frameSum = 0.f;
+    float frameMax = 0.f;
+    float simulateSum = 0.f;
+    float renderSum = 0.f;
+    for (std::size_t i = 0; i < m_filled; ++i) {
+        const PerfSample& s = m_samples[i];
+        frameSum += s.frameMs;
+        frameMax = std::max(frameMax, s.frameMs);
+        simulateSum += s.simulateMs;
+        renderSum += s.renderMs;
+    }
+    const float n = static_cast<float>(m_filled);
+    const PerfSample& last = m_samples[(m_next + HISTORY - 1) % HISTORY];
+    char text[320];
+    std::snprintf(text, sizeof(text),
+                  "FPS %.0f  frame %.2f ms avg, %.2f max\n"
+                  "simulate %.3f ms  render %.3f ms\n"
+                  "draw calls %zu  vertices %zu\n"
+                  "enemies %d  bullets %d  enemy bullets %d\n"
+                  "particles %d  overlay %.3f ms",
+                  frameSum > 0.f ? 1000.f * n / frameSum : 0.f, frameSum / n, frameMax,
+                  simulateSum / n, renderSum / n,
+                  last.drawCalls, last.vertices,
+                  m_counts.enemies, m_counts.bullets, m_counts.enemyBullets,
+                  m_counts.particles, m_overlayMs);
+    m_text.setString(text);
+}
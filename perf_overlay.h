@@ -0,0 +1,58 @@
+﻿#pragma once
+#include <SFML/Graphics.hpp>
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include "game.h"
+
+// Pomiary jednej klatki okna
+struct PerfSample {
+    float frameMs;    // Odstęp między klatkami
+    float simulateMs; // Wejście gracza i stepGame
+    float renderMs;   // Nagranie i wysłanie rysowania (bez display)
+    std::size_t drawCalls;
+    std::size_t vertices;
+};
+
+// Żywe obiekty gry
+struct EntityCounts {
+    int enemies;
+    int bullets;
+    int enemyBullets;
+    int particles;
+};
+
+EntityCounts countEntities(Game& game);
+
+// --- Nakładka wydajności (F3) ---
+// Wykres czasów ostatnich HISTORY klatek (symulacja, rysowanie, reszta) z linią budżetu 60 FPS,
+// pod nim FPS, draw calle, wierzchołki i liczby obiektów. Tło i wykres to jedna sf::VertexArray,
+// a tekst jest składany od nowa tylko co TEXT_REFRESH sekund, więc nakładka to dwa draw na klatkę.
+class PerfOverlay {
+public:
+    static const std::size_t HISTORY = 120;
+
+    explicit PerfOverlay(const sf::Font& font);
+
+    void toggle() { m_visible = !m_visible; }
+    bool visible() const { return m_visible; }
+
+    // Wywoływane co klatkę; bez widocznej nakładki nic nie robią
+    void addFrame(const PerfSample& sample, const EntityCounts& counts);
+    void draw(sf::RenderTarget& target);
+
+private:
+    void rebuildGraph();
+    void refreshText();
+
+    bool m_visible = false;
+    std::array<PerfSample, HISTORY> m_samples{};
+    std::size_t m_next = 0;  // Najstarsza próbka w buforze cyklicznym
+    std::size_t m_filled = 0;
+    EntityCounts m_counts{};
+    float m_sinceText = 0.f; // Sekundy od ostatniego składania tekstu
+    double m_overlayMs = 0.0; // Koszt nakładki w poprzedniej klatce
+
+    sf::VertexArray m_graph;
+    sf::Text m_text;
+};
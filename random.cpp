@@ -0,0 +1,23 @@
+﻿#include "random.h"
+
+void Pcg32::fillUnit(float* out, std::size_t n) {
+    // Przeskok o LANES kroków: s' = A^LANES * s + c * (A^(LANES-1) + ... + A + 1)
+    std::uint64_t jumpMultiplier = 1;
+    std::uint64_t jumpIncrement = 0;
+    std::uint64_t lanes[LANES];
+    for (int k = 0; k < LANES; ++k) {
+        lanes[k] = k == 0 ? m_state : lanes[k - 1] * MULTIPLIER + m_increment;
+        jumpIncrement = jumpIncrement * MULTIPLIER + m_increment;
+        jumpMultiplier *= MULTIPLIER;
+    }
+
+    std::size_t i = 0;
+    for (; i + LANES <= n; i += LANES) {
+        for (int k = 0; k < LANES; ++k) {
+            out[i + k] = (output(lanes[k]) >> 8) * (1.0f / 16777216.0f);
+            lanes[k] = lanes[k] * jumpMultiplier + jumpIncrement;
+        }
+    }
+    m_state = lanes[0]; // Tor 0 jest dokładnie i kroków dalej
+    for (; i < n; ++i) out[i] = nextFloat();
+}
@@ -0,0 +1,87 @@
+﻿#pragma once
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+// --- Generator PCG32 (XSH RR) ---
+// 64 bity stanu i numer strumienia (nieparzysty inkrement LCG): ten sam seed w różnych strumieniach
+// daje niezależne sekwencje. Mały stan, więc kopia gry i migawka zapisują go w całości.
+class Pcg32 {
+public:
+    static const std::uint64_t MULTIPLIER = 6364136223846793005ull;
+
+    Pcg32() : Pcg32(0, 0) {}
+    Pcg32(std::uint64_t seed, std::uint64_t stream) { this->seed(seed, stream); }
+
+    void seed(std::uint64_t seed, std::uint64_t stream) {
+        m_state = 0;
+        m_increment = (stream << 1) | 1u;
+        next();
+        m_state += seed;
+        next();
+    }
+
+    std::uint32_t next() {
+        const std::uint64_t old = m_state;
+        m_state = old * MULTIPLIER + m_increment;
+        return output(old);
+    }
+
+    // [0, 1) z 24 najstarszych bitów
+    float nextFloat() { return (next() >> 8) * (1.0f / 16777216.0f); }
+
+    float uniform(float lo, float hi) { return lo + (hi - lo) * nextFloat(); }
+
+    // [0, bound) mnożeniem zamiast modulo (bez odrzucania, odchylenie < bound / 2^32)
+    std::uint32_t below(std::uint32_t bound) {
+        return static_cast<std::uint32_t>((static_cast<std::uint64_t>(next()) * bound) >> 32);
+    }
+
+    // n liczb z [0, 1), ta sama sekwencja co n wywołań nextFloat(). Liczone na LANES przeplecionych
+    // torach LCG przesuwanych o LANES kroków naraz: iteracje są niezależne, więc procesor liczy tory
+    // równolegle (a z 64-bitowym mnożeniem SIMD, np. AVX-512, kompilator może je zwektoryzować).
+    void fillUnit(float* out, std::size_t n);
+
+    // Pełny stan (migawki)
+    std::uint64_t state() const { return m_state; }
+    std::uint64_t increment() const { return m_increment; }
+    void setState(std::uint64_t state, std::uint64_t increment) {
+        m_state = state;
+        m_increment = increment | 1u;
+    }
+
+private:
+    static const int LANES = 8;
+
+    static std::uint32_t output(std::uint64_t state) {
+        const std::uint32_t xorshifted = static_cast<std::uint32_t>(((state >> 18u) ^ state) >> 27u);
+        const std::uint32_t rotation = static_cast<std::uint32_t>(state >> 59u);
+        return (xorshifted >> rotation) | (xorshifted << ((32u - rotation) & 31u));
+    }
+
+    std::uint64_t m_state;
+    std::uint64_t m_increment;
+};
+
+// --- Losowość jednej gry ---
+// Każdy system ma własny strumień z tego samego ziarna, więc dodatkowe losowanie w jednym (np. więcej
+// cząsteczek) nie przesuwa sekwencji w innym (wybór strzelca), a cała gra odtwarza się z jednego ziarna.
+enum class RandomStream : std::uint8_t { Shooter, Particles, Count };
+
+class RandomService {
+public:
+    static const std::size_t STREAM_COUNT = static_cast<std::size_t>(RandomStream::Count);
+
+    explicit RandomService(std::uint64_t seed) { reseed(seed); }
+
+    void reseed(std::uint64_t seed) {
+        for (std::size_t i = 0; i < STREAM_COUNT; ++i) m_streams[i].seed(seed, i);
+    }
+
+    Pcg32& stream(RandomStream which) { return m_streams[static_cast<std::size_t>(which)]; }
+    Pcg32& stream(std::size_t index) { return m_streams[index]; }
+    const Pcg32& stream(std::size_t index) const { return m_streams[index]; }
+
+private:
+    std::array<Pcg32, STREAM_COUNT> m_streams;
+};
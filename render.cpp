@@ -0,0 +1,66 @@
+﻿#include "render.h"
+#include <cmath>
+#include "trace.h"
+
+namespace {
+const sf::Color BACKGROUND_COLOR(10, 0, 20); // Ciemniejsze tło
+} // namespace
+
+void RenderBackend::drawFormation(const Formation& formation) {
+    for (int cell = 0; cell < formation.cellCount(); ++cell) {
+        if (formation.isAlive(cell)) drawSprite(TextureId::Enemy, sf::FloatRect(formation.cellBounds(cell)), sf::Color::White);
+    }
+}
+
+void drawSprites(RenderBackend& out, World& world) {
+    world.each<Transform, Bounds, Renderable>(Without<Lifetime>{}, [&](Entity, Transform& transform, Bounds& bounds, Renderable& look) {
+        if (look.color == sf::Color::Transparent) return; // Rysuj gracza tylko jeśli jest widoczny
+        out.drawSprite(look.texture, sf::FloatRect(worldBounds(transform, bounds)), look.color);
+    });
+}
+
+void drawParticles(RenderBackend& out, World& world) {
+    world.each<Transform, Renderable, Lifetime>([&](Entity, Transform& transform, Renderable& look, Lifetime&) {
+        out.drawCircle(sf::Vector2f(transform.position), look.radius, look.color);
+    });
+}
+
+void drawGameFrame(RenderBackend& out, Game& game, const HudState& hud) {
+    TRACE_SCOPE("draw record");
+    out.beginFrame(BACKGROUND_COLOR);
+    const sf::Vector2f center(SCREEN_WIDTH / 2.0f, SCREEN_HEIGHT / 2.0f);
+
+    // Rysowanie zależne od stanu
+    switch (game.state) {
+        case GameState::MainMenu:
+            { // Pulsowanie tekstu startowego
+                const float scaleFactor = 1.0f + 0.05f * std::sin(hud.animationTime * 4.0f);
+                out.drawText("GALAXY INVADERS", center - sf::Vector2f(0.f, 100.f), 60, sf::Color::Cyan, TextAlign::Center, 1.0f);
+                out.drawText("Press SPACE to Start", center, 30, sf::Color::White, TextAlign::Center, scaleFactor);
+            }
+            break;
+
+        case GameState::Playing:
+            out.drawFormation(game.formation);
+            drawSprites(out, game.world);
+            out.drawText("Score: " + std::to_string(hud.shownScore), sf::Vector2f(10.f, 10.f),
+                         hud.scoreAnimating ? 30 : 24, hud.scoreAnimating ? sf::Color::Yellow : sf::Color::White,
+                         TextAlign::TopLeft, 1.0f);
+            break;
+
+        case GameState::GameOver:
+        case GameState::LevelWon: // Wspólne rysowanie dla obu końcowych stanów
+            {
+                const bool won = game.state == GameState::LevelWon;
+                const float scaleFactor = 1.0f + 0.05f * std::sin(hud.animationTime * 5.0f);
+                out.drawText(won ? "LEVEL CLEARED!" : "GAME OVER", center - sf::Vector2f(0.f, 50.f), 70,
+                             won ? sf::Color::Green : sf::Color::Red, TextAlign::Center, scaleFactor);
+                out.drawText("Final Score: " + std::to_string(game.score), center, 30, sf::Color::White, TextAlign::Center, 1.0f);
+                out.drawText("Press R to Restart", center + sf::Vector2f(0.f, 40.f), 20, sf::Color::Yellow, TextAlign::Center, 1.0f);
+            }
+            break;
+    }
+
+    // Rysuj cząsteczki na wierzchu (zawsze)
+    drawParticles(out, game.world);
+}
@@ -0,0 +1,41 @@
+﻿#pragma once
+#include <SFML/Graphics.hpp>
+#include <string>
+#include "game.h"
+
+// --- Interfejs rysowania ---
+// Scena (sprite'y, cząsteczki, teksty HUD) idzie tylko przez ten interfejs, więc tę samą klatkę może
+// narysować okno SFML albo rasteryzer CPU bez kontekstu OpenGL (pomiary, złote obrazy w CI).
+enum class TextAlign { TopLeft, Center };
+
+class RenderBackend {
+public:
+    virtual ~RenderBackend() = default;
+
+    virtual void beginFrame(sf::Color clearColor) = 0;
+    virtual void drawSprite(TextureId texture, const sf::FloatRect& dest, sf::Color color) = 0;
+    virtual void drawCircle(sf::Vector2f topLeft, float radius, sf::Color color) = 0; // Jak sf::CircleShape
+    virtual void drawRect(const sf::FloatRect& rect, sf::Color color) = 0;
+    // Center: position jest środkiem tekstu; scale mnoży rozmiar (pulsowanie napisów)
+    virtual void drawText(const std::string& text, sf::Vector2f position, unsigned int characterSize,
+                          sf::Color color, TextAlign align, float scale) = 0;
+    // Żywi wrogowie formacji; domyślnie sprite na komórkę, backend może trzymać gotową geometrię
+    virtual void drawFormation(const Formation& formation);
+    // Po ostatnim poleceniu klatki; okno i tak wyświetla klatkę samo (window.display())
+    virtual void endFrame() = 0;
+};
+
+// Stan HUD spoza symulacji (animacja wyniku i pulsowanie napisów liczone w pętli okna)
+struct HudState {
+    int shownScore;
+    bool scoreAnimating;
+    float animationTime; // Sekundy od startu ekranu (pulsowanie)
+};
+
+// Gracz i pociski (bez niewidocznego gracza po śmierci); wrogów rysuje drawFormation
+void drawSprites(RenderBackend& out, World& world);
+void drawParticles(RenderBackend& out, World& world);
+
+// Cała klatka gry w danym stanie: tło, scena, HUD, menu i ekrany końcowe. Zaczyna klatkę (beginFrame),
+// a endFrame zostaje wywołującemu, żeby mógł osobno zmierzyć nagrywanie i rysowanie.
+void drawGameFrame(RenderBackend& out, Game& game, const HudState& hud);
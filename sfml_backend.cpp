@@ -0,0 +1,205 @@
+﻿#include "sfml_backend.h"
+#include <algorithm>
+#include <cmath>
+#include "trace.h"
+
+namespace {
+const float GLYPH_PADDING = 1.0f; // Margines quada glifu, jak w sf::Text
+} // namespace
+
+SfmlRenderBackend::SfmlRenderBackend(sf::RenderTarget& target, const TextureTable& textures, const sf::Font& font)
+    : m_target(target), m_font(font), m_slots(textures.begin(), textures.end()) {
+    m_slots.push_back(nullptr); // NO_TEXTURE
+    for (int i = 0; i < CIRCLE_POINTS; ++i) {
+        const float angle = i * 2.f * 3.141592654f / CIRCLE_POINTS - 3.141592654f / 2.f;
+        m_circlePoints[i] = sf::Vector2f(std::cos(angle), std::sin(angle));
+    }
+}
+
+void SfmlRenderBackend::beginFrame(sf::Color clearColor) {
+    m_target.clear(clearColor);
+    m_recorded.clear();
+    m_commands.clear();
+    m_culled = 0;
+    const sf::View& view = m_target.getView(); // Bez obrotu: prostokąt wokół środka
+    m_viewRect = sf::FloatRect(view.getCenter() - view.getSize() / 2.f, view.getSize());
+}
+
+bool SfmlRenderBackend::visible(const sf::FloatRect& bounds) {
+    if (bounds.intersects(m_viewRect)) return true;
+    ++m_culled;
+    return false;
+}
+
+void SfmlRenderBackend::pushQuad(std::vector<sf::Vertex>& out, sf::FloatRect rect, sf::FloatRect texRect, sf::Color color) {
+    const sf::Vector2f p0(rect.left, rect.top), p1(rect.left + rect.width, rect.top);
+    const sf::Vector2f p2(rect.left + rect.width, rect.top + rect.height), p3(rect.left, rect.top + rect.height);
+    const sf::Vector2f t0(texRect.left, texRect.top), t1(texRect.left + texRect.width, texRect.top);
+    const sf::Vector2f t2(texRect.left + texRect.width, texRect.top + texRect.height), t3(texRect.left, texRect.top + texRect.height);
+    out.emplace_back(p0, color, t0);
+    out.emplace_back(p1, color, t1);
+    out.emplace_back(p3, color, t3);
+    out.emplace_back(p3, color, t3);
+    out.emplace_back(p1, color, t1);
+    out.emplace_back(p2, color, t2);
+}
+
+void SfmlRenderBackend::finishCommand(Layer layer, std::size_t slot, std::size_t firstVertex) {
+    if (m_recorded.size() == firstVertex) return;
+    const std::uint8_t key = static_cast<std::uint8_t>((static_cast<unsigned int>(layer) << LAYER_SHIFT) | slot);
+    m_commands.push_back(Command{key, static_cast<std::uint32_t>(firstVertex), static_cast<std::uint32_t>(m_recorded.size() - firstVertex), false});
+}
+
+void SfmlRenderBackend::drawSprite(TextureId texture, const sf::FloatRect& dest, sf::Color color) {
+    if (!visible(dest)) return;
+    const std::size_t slot = static_cast<std::size_t>(texture);
+    const sf::Vector2u size = m_slots[slot]->getSize();
+    const std::size_t first = m_recorded.size();
+    pushQuad(m_recorded, dest, sf::FloatRect(0.f, 0.f, static_cast<float>(size.x), static_cast<float>(size.y)), color);
+    finishCommand(Layer::Sprites, slot, first);
+}
+
+void SfmlRenderBackend::drawCircle(sf::Vector2f topLeft, float radius, sf::Color color) {
+    if (!visible(sf::FloatRect(topLeft, sf::Vector2f(2.f * radius, 2.f * radius)))) return;
+    // Wachlarz trójkątów ze środka, punkty jak w sf::CircleShape
+    const sf::Vector2f center = topLeft + sf::Vector2f(radius, radius);
+    const std::size_t first = m_recorded.size();
+    for (int i = 0; i < CIRCLE_POINTS; ++i) {
+        m_recorded.emplace_back(center, color);
+        m_recorded.emplace_back(center + m_circlePoints[i] * radius, color);
+        m_recorded.emplace_back(center + m_circlePoints[(i + 1) % CIRCLE_POINTS] * radius, color);
+    }
+    finishCommand(Layer::Shapes, NO_TEXTURE, first);
+}
+
+void SfmlRenderBackend::drawRect(const sf::FloatRect& rect, sf::Color color) {
+    if (!visible(rect)) return;
+    const std::size_t first = m_recorded.size();
+    pushQuad(m_recorded, rect, sf::FloatRect(), color);
+    finishCommand(Layer::Shapes, NO_TEXTURE, first);
+}
+
+void SfmlRenderBackend::drawText(const std::string& text, sf::Vector2f position, unsigned int characterSize,
+                                 sf::Color color, TextAlign align, float scale) {
+    const std::size_t slot = fontSlot(characterSize);
+    if (slot >= MAX_SLOTS) return; // Za dużo różnych rozmiarów w jednej klatce
+
+    // Układ glifów jak w sf::Text (linia bazowa na wysokości characterSize), granice do wyśrodkowania
+    const std::size_t first = m_recorded.size();
+    const float whitespace = m_font.getGlyph(' ', characterSize, false).advance;
+    float x = 0.f;
+    const float y = static_cast<float>(characterSize);
+    float minX = y, minY = y, maxX = 0.f, maxY = 0.f;
+    sf::Uint32 previous = 0;
+    for (char c : text) {
+        const sf::Uint32 current = static_cast<unsigned char>(c);
+        x += m_font.getKerning(previous, current, characterSize);
+        previous = current;
+        if (current == ' ') {
+            minX = std::min(minX, x);
+            minY = std::min(minY, y);
+            x += whitespace;
+            maxX = std::max(maxX, x);
+            maxY = std::max(maxY, y);
+            continue;
+        }
+        const sf::Glyph& glyph = m_font.getGlyph(current, characterSize, false);
+        const sf::FloatRect& b = glyph.bounds;
+        const sf::IntRect& t = glyph.textureRect;
+        pushQuad(m_recorded, sf::FloatRect(x + b.left - GLYPH_PADDING, y + b.top - GLYPH_PADDING, b.width + 2 * GLYPH_PADDING, b.height + 2 * GLYPH_PADDING),
+                 sf::FloatRect(t.left - GLYPH_PADDING, t.top - GLYPH_PADDING, t.width + 2 * GLYPH_PADDING, t.height + 2 * GLYPH_PADDING), color);
+        minX = std::min(minX, x + b.left);
+        maxX = std::max(maxX, x + b.left + b.width);
+        minY = std::min(minY, y + b.top);
+        maxY = std::max(maxY, y + b.top + b.height);
+        x += glyph.advance;
+    }
+
+    const sf::Vector2f origin = align == TextAlign::Center ? sf::Vector2f((minX + maxX) / 2.f, (minY + maxY) / 2.f) : sf::Vector2f();
+    const sf::Vector2f topLeft = position + (sf::Vector2f(minX, minY) - origin) * scale;
+    if (!visible(sf::FloatRect(topLeft, sf::Vector2f(maxX - minX, maxY - minY) * scale))) {
+        m_recorded.resize(first);
+        return;
+    }
+    for (std::size_t i = first; i < m_recorded.size(); ++i) {
+        m_recorded[i].position = position + (m_recorded[i].position - origin) * scale;
+    }
+    finishCommand(Layer::Text, slot, first);
+}
+
+void SfmlRenderBackend::drawFormation(const Formation& formation) {
+    if (formation.aliveCount == 0 || !visible(sf::FloatRect(formation.aliveBounds()))) return;
+    const std::size_t slot = static_cast<std::size_t>(TextureId::Enemy);
+    if (formation.generation != m_formationGeneration) {
+        const sf::Vector2u size = m_slots[slot]->getSize();
+        const sf::FloatRect texRect(0.f, 0.f, static_cast<float>(size.x), static_cast<float>(size.y));
+        m_formationVertices.clear();
+        for (int cell = 0; cell < formation.cellCount(); ++cell) {
+            if (formation.isAlive(cell)) pushQuad(m_formationVertices, sf::FloatRect(Rect(formation.cellOffset(cell), formation.enemySize)), texRect, sf::Color::White);
+        }
+        m_formationGeneration = formation.generation;
+        ++m_formationRebuilds;
+    }
+    m_formationOrigin = sf::Vector2f(formation.origin);
+    const std::uint8_t key = static_cast<std::uint8_t>((static_cast<unsigned int>(Layer::Sprites) << LAYER_SHIFT) | slot);
+    m_commands.push_back(Command{key, 0, 0, true});
+}
+
+std::size_t SfmlRenderBackend::fontSlot(unsigned int characterSize) {
+    const auto found = std::find(m_fontSizes.begin(), m_fontSizes.end(), characterSize);
+    if (found != m_fontSizes.end()) return NO_TEXTURE + 1 + static_cast<std::size_t>(found - m_fontSizes.begin());
+    if (m_slots.size() >= MAX_SLOTS) return MAX_SLOTS;
+    // Strona dla rozmiaru żyje tak długo jak czcionka (powiększa się w miejscu przy nowych glifach)
+    m_fontSizes.push_back(characterSize);
+    m_slots.push_back(&m_font.getTexture(characterSize));
+    return m_slots.size() - 1;
+}
+
+void SfmlRenderBackend::endFrame() {
+    TRACE_SCOPE("draw submit");
+    // Sortowanie przez zliczanie po 8-bitowym kluczu (jedno przejście radix sort). Jest stabilne,
+    // a polecenia są nagrane w kolejności wywołań, więc ta kolejność zostaje w obrębie klucza.
+    std::array<std::uint32_t, 256> offsets{};
+    for (const Command& command : m_commands) ++offsets[command.key];
+    std::uint32_t sum = 0;
+    for (std::uint32_t& offset : offsets) {
+        const std::uint32_t count = offset;
+        offset = sum;
+        sum += count;
+    }
+    m_sortedCommands.resize(m_commands.size());
+    for (const Command& command : m_commands) m_sortedCommands[offsets[command.key]++] = command;
+
+    // Wierzchołki w posortowanej kolejności; jeden draw na ciąg poleceń z tą samą teksturą
+    m_sorted.resize(m_recorded.size());
+    m_drawCalls = 0;
+    m_vertices = 0;
+    std::size_t batchStart = 0;
+    std::size_t end = 0;
+    std::size_t batchSlot = 0;
+    auto flushBatch = [&]() {
+        if (end == batchStart) return;
+        submit(&m_sorted[batchStart], end - batchStart, sf::RenderStates(m_slots[batchSlot]));
+        batchStart = end;
+    };
+    for (const Command& command : m_sortedCommands) {
+        const std::size_t slot = command.key & (MAX_SLOTS - 1);
+        if (slot != batchSlot || command.formation) flushBatch();
+        batchSlot = slot;
+        if (command.formation) {
+            sf::RenderStates states(m_slots[slot]);
+            states.transform.translate(m_formationOrigin);
+            submit(m_formationVertices.data(), m_formationVertices.size(), states);
+            continue;
+        }
+        std::copy_n(&m_recorded[command.firstVertex], command.vertexCount, &m_sorted[end]);
+        end += command.vertexCount;
+    }
+    flushBatch();
+}
+
+void SfmlRenderBackend::submit(const sf::Vertex* vertices, std::size_t count, const sf::RenderStates& states) {
+    m_target.draw(vertices, count, sf::Triangles, states);
+    ++m_drawCalls;
+    m_vertices += count;
+}
@@ -0,0 +1,81 @@
+﻿#pragma once
+#include <SFML/Graphics.hpp>
+#include <array>
+#include <cstdint>
+#include <vector>
+#include "render.h"
+
+// Tekstury w kolejności TextureId
+using TextureTable = std::array<const sf::Texture*, static_cast<std::size_t>(TextureId::Count)>;
+
+// --- Rysowanie przez SFML (okno albo sf::RenderTexture) ---
+// Wywołania tylko nagrywają trójkąty do bufora poleceń z kluczem stanu (warstwa, tekstura). endFrame()
+// sortuje polecenia po kluczu (stabilnie, więc w obrębie klucza zostaje kolejność wywołań) i wysyła
+// sąsiednie polecenia z tą samą teksturą jednym draw. Liczba draw na klatkę zależy od liczby tekstur
+// i rozmiarów czcionki na ekranie, a nie od liczby obiektów. Obiekty poza widokiem celu (getView())
+// są pomijane już przy nagrywaniu. Geometria formacji jest budowana w jej układzie tylko po zmianie
+// żywych komórek i rysowana z przesunięciem origin w sf::RenderStates.
+class SfmlRenderBackend : public RenderBackend {
+public:
+    SfmlRenderBackend(sf::RenderTarget& target, const TextureTable& textures, const sf::Font& font);
+
+    void beginFrame(sf::Color clearColor) override;
+    void drawSprite(TextureId texture, const sf::FloatRect& dest, sf::Color color) override;
+    void drawCircle(sf::Vector2f topLeft, float radius, sf::Color color) override;
+    void drawRect(const sf::FloatRect& rect, sf::Color color) override;
+    void drawText(const std::string& text, sf::Vector2f position, unsigned int characterSize,
+                  sf::Color color, TextAlign align, float scale) override;
+    void drawFormation(const Formation& formation) override; // Jedna formacja na klatkę
+    void endFrame() override; // Sortowanie i wysłanie; window.display() wywołuje pętla okna
+
+    // Statystyki ostatniej klatki
+    std::size_t commandCount() const { return m_commands.size(); }
+    std::size_t drawCalls() const { return m_drawCalls; }
+    std::size_t vertexCount() const { return m_vertices; } // Wysłane do celu
+    std::size_t culledCount() const { return m_culled; }
+    std::size_t formationRebuilds() const { return m_formationRebuilds; } // Od początku
+
+private:
+    // Warstwy w kolejności rysowania (jak drawGameFrame: scena, HUD, cząsteczki na wierzchu)
+    enum class Layer : std::uint8_t { Sprites, Text, Shapes };
+
+    static const int LAYER_SHIFT = 6;          // Klucz: 2 bity warstwy, 6 bitów numeru tekstury
+    static const std::size_t MAX_SLOTS = 64;
+    static const std::size_t NO_TEXTURE = static_cast<std::size_t>(TextureId::Count); // Kształty bez tekstury
+    static const int CIRCLE_POINTS = 30;       // Jak domyślne sf::CircleShape
+
+    struct Command {
+        std::uint8_t key;          // (warstwa << LAYER_SHIFT) | numer tekstury
+        std::uint32_t firstVertex; // Zakres w m_recorded
+        std::uint32_t vertexCount;
+        bool formation;            // Zamiast zakresu: m_formationVertices przesunięte o m_formationOrigin
+    };
+
+    static void pushQuad(std::vector<sf::Vertex>& out, sf::FloatRect rect, sf::FloatRect texRect, sf::Color color);
+    void finishCommand(Layer layer, std::size_t slot, std::size_t firstVertex);
+    bool visible(const sf::FloatRect& bounds); // Liczy pominięte
+    std::size_t fontSlot(unsigned int characterSize); // Strona tekstury czcionki dla rozmiaru
+    void submit(const sf::Vertex* vertices, std::size_t count, const sf::RenderStates& states); // m_target.draw z licznikami
+
+    sf::RenderTarget& m_target;
+    const sf::Font& m_font;
+    std::vector<const sf::Texture*> m_slots; // Tekstury gry, brak tekstury, potem strony czcionki
+    std::vector<unsigned int> m_fontSizes;   // Rozmiar czcionki dla slotów od NO_TEXTURE + 1
+    std::array<sf::Vector2f, CIRCLE_POINTS> m_circlePoints; // Okrąg jednostkowy od góry
+    sf::FloatRect m_viewRect; // Widok celu z początku klatki
+
+    // Pamięć zostaje między klatkami
+    std::vector<sf::Vertex> m_recorded;
+    std::vector<sf::Vertex> m_sorted;
+    std::vector<Command> m_commands;
+    std::vector<Command> m_sortedCommands;
+    std::size_t m_drawCalls = 0;
+    std::size_t m_vertices = 0;
+    std::size_t m_culled = 0;
+
+    // Formacja w układzie origin, ważna dla danej generacji (Formation::generation)
+    std::vector<sf::Vertex> m_formationVertices;
+    std::uint64_t m_formationGeneration = 0;
+    sf::Vector2f m_formationOrigin;
+    std::size_t m_formationRebuilds = 0;
+};
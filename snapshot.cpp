@@ -0,0 +1,371 @@
+﻿#include "snapshot.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include "trace.h"
+
+namespace {
+const char SNAPSHOT_MAGIC[4] = {'G', 'I', 'S', 'N'};
+const float POSITION_SCALE = 16.0f;    // Pozycje i prędkości w 1/16 px
+const float LIFETIME_SCALE = 16384.0f; // Czas życia cząsteczek w 1/16384 s (do 4 s)
+
+// Rozmiary rekordów po nagłówku liczników (muszą zgadzać się z capture/restore)
+const std::size_t BULLET_RECORD_SIZE = 9;    // x, y, vx, vy, tekstura
+const std::size_t PARTICLE_RECORD_SIZE = 15; // x, y, vx, vy, czas życia, promień, RGBA
+
+std::int16_t quantize(float value, float scale) {
+    const long q = std::lround(value * scale);
+    return static_cast<std::int16_t>(std::max(-32768L, std::min(32767L, q)));
+}
+
+class ByteWriter {
+public:
+    explicit ByteWriter(std::vector<std::uint8_t>& out) : m_out(out) {}
+
+    void u8(std::uint8_t v) { m_out.push_back(v); }
+    void u16(std::uint16_t v) { for (int i = 0; i < 2; ++i) u8(static_cast<std::uint8_t>(v >> (8 * i))); }
+    void u32(std::uint32_t v) { for (int i = 0; i < 4; ++i) u8(static_cast<std::uint8_t>(v >> (8 * i))); }
+    void u64(std::uint64_t v) { for (int i = 0; i < 8; ++i) u8(static_cast<std::uint8_t>(v >> (8 * i))); }
+    void i16(std::int16_t v) { u16(static_cast<std::uint16_t>(v)); }
+    void f32(float v) {
+        std::uint32_t bits;
+        std::memcpy(&bits, &v, sizeof bits);
+        u32(bits);
+    }
+
+    // Licznik rekordów uzupełniany po ich zapisaniu
+    std::size_t placeholder16() {
+        u16(0);
+        return m_out.size() - 2;
+    }
+    void patch16(std::size_t at, std::uint16_t v) {
+        m_out[at] = static_cast<std::uint8_t>(v);
+        m_out[at + 1] = static_cast<std::uint8_t>(v >> 8);
+    }
+
+private:
+    std::vector<std::uint8_t>& m_out;
+};
+
+class ByteReader {
+public:
+    explicit ByteReader(const std::vector<std::uint8_t>& data) : m_data(data) {}
+
+    bool ok() const { return m_ok; }
+    bool atEnd() const { return m_pos == m_data.size(); }
+
+    void skip(std::size_t bytes) {
+        if (m_data.size() - m_pos < bytes) m_ok = false;
+        else m_pos += bytes;
+    }
+    std::uint8_t u8() {
+        if (m_pos >= m_data.size()) {
+            m_ok = false;
+            return 0;
+        }
+        return m_data[m_pos++];
+    }
+    std::uint16_t u16() {
+        const std::uint8_t low = u8();
+        return static_cast<std::uint16_t>(low | (u8() << 8));
+    }
+    std::uint32_t u32() {
+        std::uint32_t v = 0;
+        for (int i = 0; i < 4; ++i) v |= static_cast<std::uint32_t>(u8()) << (8 * i);
+        return v;
+    }
+    std::uint64_t u64() {
+        std::uint64_t v = 0;
+        for (int i = 0; i < 8; ++i) v |= static_cast<std::uint64_t>(u8()) << (8 * i);
+        return v;
+    }
+    std::int16_t i16() { return static_cast<std::int16_t>(u16()); }
+    float f32() {
+        const std::uint32_t bits = u32();
+        float v;
+        std::memcpy(&v, &bits, sizeof v);
+        return v;
+    }
+    sf::Vector2f vec2() {
+        const float x = f32();
+        return sf::Vector2f(x, f32());
+    }
+
+private:
+    const std::vector<std::uint8_t>& m_data;
+    std::size_t m_pos = 0;
+    bool m_ok = true;
+};
+
+// Nagłówek i część stała aż do liczby słów bitsetu formacji włącznie
+const std::size_t HEADER_SIZE = 4 + 2; // Magia, wersja
+const std::size_t RANDOM_SIZE = RandomService::STREAM_COUNT * (8 + 8); // Stan i inkrement każdego strumienia
+const std::size_t GAME_FIELDS_SIZE =
+    1 + 4 + 4 + 4 + 4 + // Stan, wynik, kroki, czas przeżycia, fale
+    4 + 1 + 4 +         // Kierunek, zejście formacji, odliczanie strzału wrogów
+    RANDOM_SIZE;
+const std::size_t FIXED_SIZE =
+    HEADER_SIZE + GAME_FIELDS_SIZE +
+    1 + 8 + 1 + 8 +     // Gracz: czy jest, pozycja, widoczność, pozycja z poprzedniego kroku
+    8 + 2;              // Formacja: offset, liczba słów bitsetu
+
+// Pocisk z prędkością i teksturą: pociski wachlarza lecą ukośnie, a nurkujący wróg to "pocisk" z teksturą wroga
+void writeBullets(ByteWriter& writer, World& world, Team wanted) {
+    const std::size_t countAt = writer.placeholder16();
+    std::uint16_t count = 0;
+    world.each<Transform, Velocity, Bounds, Renderable, Team>(
+        [&](Entity, Transform& transform, Velocity& velocity, Bounds&, Renderable& look, Team& team) {
+            if (team != wanted || count == UINT16_MAX) return;
+            writer.i16(quantize(static_cast<float>(transform.position.x), POSITION_SCALE));
+            writer.i16(quantize(static_cast<float>(transform.position.y), POSITION_SCALE));
+            writer.i16(quantize(static_cast<float>(velocity.value.x), POSITION_SCALE));
+            writer.i16(quantize(static_cast<float>(velocity.value.y), POSITION_SCALE));
+            writer.u8(static_cast<std::uint8_t>(look.texture));
+            ++count;
+        });
+    writer.patch16(countAt, count);
+}
+
+// Tylko tekstury, dla których restore zna rozmiar
+bool isBulletTexture(std::uint8_t texture) {
+    return texture == static_cast<std::uint8_t>(TextureId::Bullet) ||
+           texture == static_cast<std::uint8_t>(TextureId::EnemyBullet) ||
+           texture == static_cast<std::uint8_t>(TextureId::Enemy);
+}
+
+bool checkBullets(ByteReader& check) {
+    const std::uint16_t count = check.u16();
+    for (std::uint16_t i = 0; i < count; ++i) {
+        check.skip(BULLET_RECORD_SIZE - 1);
+        if (!isBulletTexture(check.u8())) return false;
+    }
+    return check.ok();
+}
+
+// Zwraca liczbę nurkujących wrogów
+int readBullets(ByteReader& reader, World& world, Team team, const GameAssets& assets) {
+    const std::uint16_t count = reader.u16();
+    int divers = 0;
+    for (std::uint16_t i = 0; i < count; ++i) {
+        const float x = reader.i16() / POSITION_SCALE;
+        const float y = reader.i16() / POSITION_SCALE;
+        const float vx = reader.i16() / POSITION_SCALE;
+        const float vy = reader.i16() / POSITION_SCALE;
+        const TextureId texture = static_cast<TextureId>(reader.u8());
+        Vec2 size = assets.bulletSize;
+        switch (texture) {
+            case TextureId::Enemy:
+                size = assets.enemySize;
+                ++divers;
+                break;
+            case TextureId::EnemyBullet: size = assets.enemyBulletSize; break;
+            default: break;
+        }
+        world.spawn(Transform{Vec2(Scalar(x), Scalar(y))}, Velocity{Vec2(Scalar(vx), Scalar(vy))}, Bounds{size},
+                    Renderable{texture}, team);
+    }
+    return divers;
+}
+} // namespace
+
+void captureSnapshot(Game& game, const GameAssets& assets, std::vector<std::uint8_t>& out) {
+    TRACE_SCOPE("capture snapshot");
+    out.clear();
+    ByteWriter writer(out);
+    for (char c : SNAPSHOT_MAGIC) writer.u8(static_cast<std::uint8_t>(c));
+    writer.u16(SNAPSHOT_VERSION);
+
+    writer.u8(static_cast<std::uint8_t>(game.state));
+    writer.u32(static_cast<std::uint32_t>(game.score));
+    writer.u32(static_cast<std::uint32_t>(game.steps));
+    writer.f32(game.survivalTime);
+    writer.u32(static_cast<std::uint32_t>(game.wavesCleared));
+    writer.f32(game.enemyDirection);
+    writer.u8(game.moveEnemiesDown ? 1 : 0);
+    writer.u32(static_cast<std::uint32_t>(std::lround(enemyShotElapsed(game) * 1.0e6f)));
+    for (std::size_t i = 0; i < RandomService::STREAM_COUNT; ++i) {
+        writer.u64(game.random.stream(i).state());
+        writer.u64(game.random.stream(i).increment());
+    }
+
+    // Gracz (w menu świat jest pusty)
+    const bool hasPlayer = game.world.isAlive(game.player);
+    writer.u8(hasPlayer ? 1 : 0);
+    const sf::Vector2f playerPos = hasPlayer ? sf::Vector2f(game.world.get<Transform>(game.player).position) : sf::Vector2f();
+    const bool playerVisible = hasPlayer && game.world.get<Renderable>(game.player).color != sf::Color::Transparent;
+    writer.f32(playerPos.x);
+    writer.f32(playerPos.y);
+    writer.u8(playerVisible ? 1 : 0);
+    writer.f32(static_cast<float>(game.lastPlayerPosition.x));
+    writer.f32(static_cast<float>(game.lastPlayerPosition.y));
+
+    // Formacja: przesunięcie od startu fali i bit na komórkę siatki (w menu formacja jest pusta)
+    const sf::Vector2f offset(game.formation.origin - formationStart(assets.enemySize));
+    writer.f32(offset.x);
+    writer.f32(offset.y);
+    writer.u16(static_cast<std::uint16_t>(game.formation.alive.size()));
+    for (std::uint64_t word : game.formation.alive) writer.u64(word);
+
+    writeBullets(writer, game.world, Team::Player);
+    writeBullets(writer, game.world, Team::Enemy);
+
+    const std::size_t particleCountAt = writer.placeholder16();
+    std::uint16_t particleCount = 0;
+    game.world.each<Transform, Velocity, Renderable, Lifetime>([&](Entity, Transform& transform, Velocity& velocity, Renderable& look, Lifetime& lifetime) {
+        if (particleCount == UINT16_MAX) return;
+        writer.i16(quantize(static_cast<float>(transform.position.x), POSITION_SCALE));
+        writer.i16(quantize(static_cast<float>(transform.position.y), POSITION_SCALE));
+        writer.i16(quantize(static_cast<float>(velocity.value.x), POSITION_SCALE));
+        writer.i16(quantize(static_cast<float>(velocity.value.y), POSITION_SCALE));
+        writer.u16(static_cast<std::uint16_t>(std::min(65535L, std::max(0L, std::lround(lifetime.remaining * LIFETIME_SCALE)))));
+        writer.u8(static_cast<std::uint8_t>(look.radius));
+        writer.u8(look.color.r);
+        writer.u8(look.color.g);
+        writer.u8(look.color.b);
+        writer.u8(look.color.a);
+        ++particleCount;
+    });
+    writer.patch16(particleCountAt, particleCount);
+}
+
+bool restoreSnapshot(Game& game, const GameAssets& assets, const std::vector<std::uint8_t>& data) {
+    TRACE_SCOPE("restore snapshot");
+    // Pierwsze przejście: tylko walidacja, żeby uszkodzona migawka nie zostawiła pół-odtworzonej gry
+    {
+        ByteReader check(data);
+        for (char c : SNAPSHOT_MAGIC) {
+            if (check.u8() != static_cast<std::uint8_t>(c)) return false;
+        }
+        if (check.u16() != SNAPSHOT_VERSION) return false;
+        const std::uint8_t state = check.u8();
+        if (state > static_cast<std::uint8_t>(GameState::LevelWon)) return false;
+        check.skip(GAME_FIELDS_SIZE - 1);
+        // Poza menu gra zawsze ma gracza
+        if (check.u8() == 0 && state != static_cast<std::uint8_t>(GameState::MainMenu)) return false;
+        check.skip(FIXED_SIZE - HEADER_SIZE - GAME_FIELDS_SIZE - 1 - 2);
+        // Formacja z innego buildu (inna siatka) się nie zmieści
+        const std::uint16_t aliveWords = check.u16();
+        if (aliveWords > cellWords(FORMATION_COLUMNS * FORMATION_ROWS)) return false;
+        check.skip(aliveWords * std::size_t(8));
+        if (!checkBullets(check) || !checkBullets(check)) return false;
+        check.skip(check.u16() * PARTICLE_RECORD_SIZE);
+        if (!check.ok() || !check.atEnd()) return false;
+    }
+
+    ByteReader reader(data);
+    reader.skip(HEADER_SIZE);
+    game.state = static_cast<GameState>(reader.u8());
+    game.score = static_cast<int>(reader.u32());
+    game.steps = reader.u32();
+    game.survivalTime = reader.f32();
+    game.wavesCleared = static_cast<int>(reader.u32());
+    game.enemyDirection = reader.f32();
+    game.moveEnemiesDown = reader.u8() != 0;
+    const float enemyShotSince = reader.u32() / 1.0e6f;
+    for (std::size_t i = 0; i < RandomService::STREAM_COUNT; ++i) {
+        const std::uint64_t state = reader.u64();
+        game.random.stream(i).setState(state, reader.u64());
+    }
+
+    restoreEnemyShotTimer(game, enemyShotSince);
+
+    World& world = game.world;
+    world.clear();
+    game.commands.clear();
+
+    const bool hasPlayer = reader.u8() != 0;
+    const Vec2 playerPos(reader.vec2());
+    const bool playerVisible = reader.u8() != 0;
+    game.lastPlayerPosition = Vec2(reader.vec2());
+    if (hasPlayer) {
+        Renderable look{TextureId::Player};
+        if (!playerVisible) look.color = sf::Color::Transparent;
+        game.player = world.spawn(Transform{playerPos}, Bounds{assets.playerSize}, look, Team::Player);
+    }
+
+    const Vec2 offset(reader.vec2());
+    std::vector<std::uint64_t> alive(reader.u16()); // W menu formacja jest pusta: 0 słów, wszyscy martwi
+    for (std::uint64_t& word : alive) word = reader.u64();
+    game.formation.reset(FORMATION_COLUMNS, FORMATION_ROWS, formationStart(assets.enemySize) + offset,
+                         assets.enemySize * Scalar(FORMATION_SPACING), assets.enemySize);
+    game.formation.setAlive(alive);
+
+    // Nurkujący dostaną skrypty sterujące w pierwszym kroku (restoreEnemyShotTimer prosi o restart)
+    game.divers = readBullets(reader, world, Team::Player, assets) + readBullets(reader, world, Team::Enemy, assets);
+
+    const std::uint16_t particleCount = reader.u16();
+    for (std::uint16_t i = 0; i < particleCount; ++i) {
+        const float x = reader.i16() / POSITION_SCALE;
+        const float y = reader.i16() / POSITION_SCALE;
+        const float vx = reader.i16() / POSITION_SCALE;
+        const float vy = reader.i16() / POSITION_SCALE;
+        const float remaining = reader.u16() / LIFETIME_SCALE;
+        Renderable look;
+        look.radius = reader.u8();
+        look.color.r = reader.u8();
+        look.color.g = reader.u8();
+        look.color.b = reader.u8();
+        look.color.a = reader.u8();
+        world.spawn(Transform{Vec2(Scalar(x), Scalar(y))}, Velocity{Vec2(Scalar(vx), Scalar(vy))}, look, Lifetime{remaining});
+    }
+    return true;
+}
+
+bool readSnapshotFile(const std::string& path, std::vector<std::uint8_t>& data) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file) return false;
+    data.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    return true;
+}
+
+SnapshotWriter::SnapshotWriter() : m_thread(&SnapshotWriter::run, this) {}
+
+SnapshotWriter::~SnapshotWriter() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stopping = true;
+    }
+    m_jobAdded.notify_all();
+    m_thread.join();
+}
+
+void SnapshotWriter::save(const std::string& path, std::vector<std::uint8_t> data) {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_jobs.push_back(Job{path, std::move(data)});
+    }
+    m_jobAdded.notify_one();
+}
+
+void SnapshotWriter::run() {
+    setTraceThreadName("snapshot writer");
+    std::unique_lock<std::mutex> lock(m_mutex);
+    for (;;) {
+        m_jobAdded.wait(lock, [this] { return m_stopping || !m_jobs.empty(); });
+        if (m_jobs.empty()) return; // Zatrzymanie dopiero po opróżnieniu kolejki
+        Job job = std::move(m_jobs.front());
+        m_jobs.pop_front();
+        lock.unlock();
+
+        TRACE_SCOPE("write snapshot");
+        const std::string tempPath = job.path + ".tmp";
+        bool written;
+        {
+            std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+            file.write(reinterpret_cast<const char*>(job.data.data()), static_cast<std::streamsize>(job.data.size()));
+            written = static_cast<bool>(file);
+        }
+        if (written && std::rename(tempPath.c_str(), job.path.c_str()) != 0) {
+            // Windows nie nadpisuje istniejącego pliku przez rename
+            std::remove(job.path.c_str());
+            written = std::rename(tempPath.c_str(), job.path.c_str()) == 0;
+        }
+
+        if (!written) std::cerr << "Snapshot: could not write " << job.path << "\n";
+        lock.lock();
+    }
+}
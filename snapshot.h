@@ -0,0 +1,54 @@
+﻿#pragma once
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "game.h"
+
+// --- Migawka stanu gry (zapis/odczyt binarny) ---
+// Format wersjonowany, little-endian: nagłówek "GISN" + wersja, potem stan rozgrywki, gracz,
+// formacja jako offset + bitset żywych komórek (liczba słów i słowa 64-bitowe), pociski (z nurkującymi
+// wrogami) z prędkością i teksturą oraz cząsteczki, z pozycjami i prędkościami kwantowanymi do 1/16 px
+// (int16). Odliczania są zapisane jako reszty w mikrosekundach.
+// Wersja 2: pełny stan strumieni PCG zamiast nowego ziarna mt19937.
+// Wersja 3: bitset formacji o zmiennej długości zamiast jednego słowa (formacje ponad 64 wrogów).
+// Wersja 4: prędkość i tekstura każdego pocisku (ukośne pociski wachlarza, nurkujący wrogowie).
+const std::uint16_t SNAPSHOT_VERSION = 4;
+
+// Zapisuje stan do out (bufor jest nadpisywany, jego pojemność wykorzystana ponownie).
+// Strumienie losowe są zapisane w całości, więc gra i jej odtworzenie losują dalej to samo.
+void captureSnapshot(Game& game, const GameAssets& assets, std::vector<std::uint8_t>& out);
+
+// Odtwarza stan z migawki; przy złym nagłówku, wersji lub uciętych danych zwraca false i nie zmienia gry
+bool restoreSnapshot(Game& game, const GameAssets& assets, const std::vector<std::uint8_t>& data);
+
+bool readSnapshotFile(const std::string& path, std::vector<std::uint8_t>& data);
+
+// --- Zapis migawek na dysk w tle ---
+// save() tylko przekazuje bufor do kolejki, więc klatka nigdy nie czeka na I/O. Plik powstaje pod nazwą
+// tymczasową i jest podmieniany przez rename, więc po awarii zostaje poprzednia pełna migawka.
+class SnapshotWriter {
+public:
+    SnapshotWriter();
+    ~SnapshotWriter(); // Dopisuje zaległe migawki i kończy wątek
+
+    // Błąd zapisu jest zgłaszany na std::cerr z wątku zapisującego
+    void save(const std::string& path, std::vector<std::uint8_t> data);
+
+private:
+    struct Job {
+        std::string path;
+        std::vector<std::uint8_t> data;
+    };
+
+    void run();
+
+    std::mutex m_mutex;
+    std::condition_variable m_jobAdded;
+    std::deque<Job> m_jobs;
+    bool m_stopping = false;
+    std::thread m_thread;
+};
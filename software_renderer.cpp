@@ -0,0 +1,226 @@
+﻿#include "software_renderer.h"
+#include <algorithm>
+#include <cmath>
+#include "bitmap_font.h"
+#include "trace.h"
+
+namespace {
+const float GLYPH_PIXELS_PER_SIZE = 0.1f; // Glif 7 px wysokości = 0.7 rozmiaru znaku (jak wielkie litery)
+const float TEXT_TOP_GAP = 0.2f;          // Odstęp nad wielkimi literami przy TextAlign::TopLeft
+
+// Zakres pikseli [first, last) ze środkami w [lo, hi), przycięty do [clipLo, clipHi)
+void pixelSpan(float lo, float hi, int clipLo, int clipHi, int& first, int& last) {
+    first = std::max(clipLo, static_cast<int>(std::ceil(lo - 0.5f)));
+    last = std::min(clipHi, static_cast<int>(std::ceil(hi - 0.5f)));
+}
+
+// Mieszanie jak sf::BlendAlpha: kolor src * a + dst * (1 - a)
+inline void blend(std::uint8_t* dst, unsigned int r, unsigned int g, unsigned int b, unsigned int a) {
+    if (a == 0) return;
+    const unsigned int inv = 255 - a;
+    dst[0] = static_cast<std::uint8_t>((r * a + dst[0] * inv + 127) / 255);
+    dst[1] = static_cast<std::uint8_t>((g * a + dst[1] * inv + 127) / 255);
+    dst[2] = static_cast<std::uint8_t>((b * a + dst[2] * inv + 127) / 255);
+    dst[3] = static_cast<std::uint8_t>(a + (dst[3] * inv + 127) / 255);
+}
+} // namespace
+
+SoftwareRenderer::SoftwareRenderer(unsigned int width, unsigned int height, const GameImages& images, unsigned int threads)
+    : m_width(width),
+      m_height(height),
+      m_tilesX((width + TILE_SIZE - 1) / TILE_SIZE),
+      m_tilesY((height + TILE_SIZE - 1) / TILE_SIZE),
+      m_pixels(static_cast<std::size_t>(width) * height * 4),
+      m_images{{images.player, images.enemy, images.bullet, images.enemyBullet}},
+      m_tileCommands(m_tilesX * m_tilesY) {
+    for (std::size_t i = 0; i < m_images.size(); ++i) {
+        m_sources[i] = SourceImage{m_images[i].getPixelsPtr(), m_images[i].getSize().x, m_images[i].getSize().y};
+    }
+    if (threads == 0) threads = std::thread::hardware_concurrency();
+    for (unsigned int i = 1; i < std::max(1u, threads); ++i) m_workers.emplace_back(&SoftwareRenderer::workerLoop, this);
+}
+
+SoftwareRenderer::~SoftwareRenderer() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stopping = true;
+    }
+    m_frameReady.notify_all();
+    for (auto& worker : m_workers) worker.join();
+}
+
+void SoftwareRenderer::beginFrame(sf::Color clearColor) {
+    m_clearColor = clearColor;
+    m_commands.clear();
+}
+
+void SoftwareRenderer::drawSprite(TextureId texture, const sf::FloatRect& dest, sf::Color color) {
+    push(Command{Kind::Sprite, texture, color, dest, nullptr});
+}
+
+void SoftwareRenderer::drawCircle(sf::Vector2f topLeft, float radius, sf::Color color) {
+    push(Command{Kind::Circle, TextureId::Count, color, sf::FloatRect(topLeft.x, topLeft.y, 2.f * radius, 2.f * radius), nullptr});
+}
+
+void SoftwareRenderer::drawRect(const sf::FloatRect& rect, sf::Color color) {
+    push(Command{Kind::Rect, TextureId::Count, color, rect, nullptr});
+}
+
+void SoftwareRenderer::drawText(const std::string& text, sf::Vector2f position, unsigned int characterSize,
+                                sf::Color color, TextAlign align, float scale) {
+    // Każdy znak to osobny prostokąt glifu (quad) w poleceniach
+    const float pixel = characterSize * scale * GLYPH_PIXELS_PER_SIZE;
+    const float width = (static_cast<float>(text.size()) * GLYPH_ADVANCE - 1) * pixel;
+    sf::Vector2f origin = position;
+    if (align == TextAlign::Center) origin -= sf::Vector2f(width / 2.f, GLYPH_HEIGHT * pixel / 2.f);
+    else origin.y += characterSize * scale * TEXT_TOP_GAP;
+
+    for (std::size_t i = 0; i < text.size(); ++i) {
+        if (text[i] == ' ') continue;
+        const sf::FloatRect cell(origin.x + i * GLYPH_ADVANCE * pixel, origin.y, GLYPH_WIDTH * pixel, GLYPH_HEIGHT * pixel);
+        push(Command{Kind::Glyph, TextureId::Count, color, cell, glyphRows(text[i])});
+    }
+}
+
+void SoftwareRenderer::push(const Command& command) {
+    if (command.bounds.width <= 0.f || command.bounds.height <= 0.f || command.color.a == 0) return;
+    m_commands.push_back(command);
+}
+
+void SoftwareRenderer::endFrame() {
+    TRACE_SCOPE("rasterize");
+    // Przypisanie poleceń do kafelków (kolejność wywołań zostaje w każdej liście)
+    for (auto& list : m_tileCommands) list.clear();
+    for (std::size_t i = 0; i < m_commands.size(); ++i) {
+        const sf::FloatRect& b = m_commands[i].bounds;
+        int x0, x1, y0, y1;
+        pixelSpan(b.left, b.left + b.width, 0, static_cast<int>(m_width), x0, x1);
+        pixelSpan(b.top, b.top + b.height, 0, static_cast<int>(m_height), y0, y1);
+        if (x0 >= x1 || y0 >= y1) continue; // Poza ekranem
+        for (int ty = y0 / TILE_SIZE; ty <= (y1 - 1) / TILE_SIZE; ++ty) {
+            for (int tx = x0 / TILE_SIZE; tx <= (x1 - 1) / TILE_SIZE; ++tx) {
+                m_tileCommands[ty * m_tilesX + tx].push_back(static_cast<std::uint32_t>(i));
+            }
+        }
+    }
+
+    m_nextTile.store(0);
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        ++m_frame;
+        m_busyWorkers = static_cast<unsigned int>(m_workers.size());
+    }
+    m_frameReady.notify_all();
+    rasterizeTiles();
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_frameDone.wait(lock, [&]() { return m_busyWorkers == 0; });
+}
+
+sf::Image SoftwareRenderer::toImage() const {
+    sf::Image image;
+    image.create(m_width, m_height, m_pixels.data());
+    return image;
+}
+
+void SoftwareRenderer::workerLoop() {
+    setTraceThreadName("raster worker");
+    unsigned long seenFrame = 0;
+    for (;;) {
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_frameReady.wait(lock, [&]() { return m_stopping || m_frame != seenFrame; });
+            if (m_stopping) return;
+            seenFrame = m_frame;
+        }
+        rasterizeTiles();
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (--m_busyWorkers == 0) m_frameDone.notify_one();
+    }
+}
+
+void SoftwareRenderer::rasterizeTiles() {
+    TRACE_SCOPE("raster tiles");
+    const unsigned int tileCount = m_tilesX * m_tilesY;
+    for (unsigned int tile = m_nextTile.fetch_add(1); tile < tileCount; tile = m_nextTile.fetch_add(1)) rasterizeTile(tile);
+}
+
+void SoftwareRenderer::rasterizeTile(unsigned int tile) {
+    const int tileX0 = static_cast<int>(tile % m_tilesX) * TILE_SIZE;
+    const int tileY0 = static_cast<int>(tile / m_tilesX) * TILE_SIZE;
+    const int tileX1 = std::min(tileX0 + TILE_SIZE, static_cast<int>(m_width));
+    const int tileY1 = std::min(tileY0 + TILE_SIZE, static_cast<int>(m_height));
+    const std::size_t stride = static_cast<std::size_t>(m_width) * 4;
+
+    for (int y = tileY0; y < tileY1; ++y) {
+        std::uint8_t* row = &m_pixels[y * stride];
+        for (int x = tileX0; x < tileX1; ++x) {
+            std::uint8_t* p = row + x * 4;
+            p[0] = m_clearColor.r;
+            p[1] = m_clearColor.g;
+            p[2] = m_clearColor.b;
+            p[3] = 255;
+        }
+    }
+
+    for (std::uint32_t index : m_tileCommands[tile]) {
+        const Command& command = m_commands[index];
+        const sf::FloatRect& b = command.bounds;
+        const sf::Color c = command.color;
+        int x0, x1, y0, y1;
+        pixelSpan(b.left, b.left + b.width, tileX0, tileX1, x0, x1);
+        pixelSpan(b.top, b.top + b.height, tileY0, tileY1, y0, y1);
+
+        switch (command.kind) {
+            case Kind::Sprite: {
+                // Najbliższy teksel, kolor modulowany jak sf::Sprite::setColor
+                const SourceImage& source = m_sources[static_cast<std::size_t>(command.texture)];
+                const float scaleX = source.width / b.width;
+                const float scaleY = source.height / b.height;
+                for (int y = y0; y < y1; ++y) {
+                    const unsigned int v = std::min(source.height - 1, static_cast<unsigned int>((y + 0.5f - b.top) * scaleY));
+                    const std::uint8_t* sourceRow = source.pixels + static_cast<std::size_t>(v) * source.width * 4;
+                    std::uint8_t* row = &m_pixels[y * stride];
+                    for (int x = x0; x < x1; ++x) {
+                        const unsigned int u = std::min(source.width - 1, static_cast<unsigned int>((x + 0.5f - b.left) * scaleX));
+                        const std::uint8_t* t = sourceRow + u * 4;
+                        blend(row + x * 4, t[0] * c.r / 255u, t[1] * c.g / 255u, t[2] * c.b / 255u, t[3] * c.a / 255u);
+                    }
+                }
+                break;
+            }
+            case Kind::Circle: {
+                const float radius = b.width / 2.f;
+                const float cx = b.left + radius;
+                const float cy = b.top + radius;
+                for (int y = y0; y < y1; ++y) {
+                    const float dy = y + 0.5f - cy;
+                    std::uint8_t* row = &m_pixels[y * stride];
+                    for (int x = x0; x < x1; ++x) {
+                        const float dx = x + 0.5f - cx;
+                        if (dx * dx + dy * dy <= radius * radius) blend(row + x * 4, c.r, c.g, c.b, c.a);
+                    }
+                }
+                break;
+            }
+            case Kind::Rect:
+                for (int y = y0; y < y1; ++y) {
+                    std::uint8_t* row = &m_pixels[y * stride];
+                    for (int x = x0; x < x1; ++x) blend(row + x * 4, c.r, c.g, c.b, c.a);
+                }
+                break;
+            case Kind::Glyph: {
+                const float pixel = b.height / GLYPH_HEIGHT;
+                for (int y = y0; y < y1; ++y) {
+                    const int gy = std::min(GLYPH_HEIGHT - 1, static_cast<int>((y + 0.5f - b.top) / pixel));
+                    const std::uint8_t bits = command.glyph[gy];
+                    std::uint8_t* row = &m_pixels[y * stride];
+                    for (int x = x0; x < x1; ++x) {
+                        const int gx = std::min(GLYPH_WIDTH - 1, static_cast<int>((x + 0.5f - b.left) / pixel));
+                        if ((bits >> (GLYPH_WIDTH - 1 - gx)) & 1u) blend(row + x * 4, c.r, c.g, c.b, c.a);
+                    }
+                }
+                break;
+            }
+        }
+    }
+}
@@ -0,0 +1,85 @@
+﻿#pragma once
+#include <SFML/Graphics.hpp>
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "render.h"
+
+// --- Rasteryzer CPU (bez OpenGL) ---
+// Polecenia klatki są tylko zapisywane; endFrame() dzieli ekran na kafelki TILE_SIZE x TILE_SIZE,
+// przypisuje polecenia do kafelków, które pokrywają, i rysuje kafelki równolegle na puli wątków.
+// Każdy kafelek wykonuje swoje polecenia w kolejności wywołań, więc wynik nie zależy od liczby wątków.
+// Tekstury są próbkowane najbliższym tekselem, kolor mieszany jak sf::BlendAlpha.
+class SoftwareRenderer : public RenderBackend {
+public:
+    static const int TILE_SIZE = 64;
+
+    // threads: wątki rasteryzacji łącznie z wywołującym (0: tyle, ile rdzeni)
+    SoftwareRenderer(unsigned int width, unsigned int height, const GameImages& images, unsigned int threads);
+    ~SoftwareRenderer();
+
+    void beginFrame(sf::Color clearColor) override;
+    void drawSprite(TextureId texture, const sf::FloatRect& dest, sf::Color color) override;
+    void drawCircle(sf::Vector2f topLeft, float radius, sf::Color color) override;
+    void drawRect(const sf::FloatRect& rect, sf::Color color) override;
+    void drawText(const std::string& text, sf::Vector2f position, unsigned int characterSize,
+                  sf::Color color, TextAlign align, float scale) override;
+    void endFrame() override;
+
+    unsigned int width() const { return m_width; }
+    unsigned int height() const { return m_height; }
+    unsigned int threadCount() const { return static_cast<unsigned int>(m_workers.size()) + 1; }
+    std::size_t commandCount() const { return m_commands.size(); } // Ostatniej klatki
+
+    // RGBA8, wiersz po wierszu (format sf::Image)
+    const std::vector<std::uint8_t>& pixels() const { return m_pixels; }
+    sf::Image toImage() const;
+
+private:
+    enum class Kind : std::uint8_t { Sprite, Circle, Rect, Glyph };
+
+    struct Command {
+        Kind kind;
+        TextureId texture;           // Sprite
+        sf::Color color;
+        sf::FloatRect bounds;        // Obszar na ekranie (dla okręgu: kwadrat opisany)
+        const std::uint8_t* glyph;   // Glyph: wiersze z bitmap_font.h
+    };
+
+    struct SourceImage {
+        const std::uint8_t* pixels;
+        unsigned int width;
+        unsigned int height;
+    };
+
+    void push(const Command& command);
+    void rasterizeTiles(); // Bierze kafelki z licznika, aż się skończą
+    void rasterizeTile(unsigned int tile);
+    void workerLoop();
+
+    unsigned int m_width;
+    unsigned int m_height;
+    unsigned int m_tilesX;
+    unsigned int m_tilesY;
+    std::vector<std::uint8_t> m_pixels;
+    std::array<sf::Image, static_cast<std::size_t>(TextureId::Count)> m_images; // Własne kopie obrazów
+    std::array<SourceImage, static_cast<std::size_t>(TextureId::Count)> m_sources;
+
+    sf::Color m_clearColor;
+    std::vector<Command> m_commands;
+    std::vector<std::vector<std::uint32_t>> m_tileCommands; // Indeksy poleceń na kafelek (pamięć zostaje)
+
+    // Pula wątków: endFrame podnosi numer klatki, wątki i wywołujący biorą kafelki z m_nextTile
+    std::vector<std::thread> m_workers;
+    std::mutex m_mutex;
+    std::condition_variable m_frameReady;
+    std::condition_variable m_frameDone;
+    unsigned long m_frame = 0;
+    unsigned int m_busyWorkers = 0;
+    bool m_stopping = false;
+    std::atomic<unsigned int> m_nextTile{0};
+};
@@ -0,0 +1,49 @@
+﻿#include "swept_collision.h"
+#include <algorithm>
+#include <cmath>
+#include <utility>
+
+namespace {
+// Zawęża [tEnter, tExit] do czasu przenikania na jednej osi; false, gdy na tej osi nie ma kontaktu
+bool clipAxis(Scalar movingMin, Scalar movingSize, Scalar delta, Scalar targetMin, Scalar targetSize, Scalar& tEnter, Scalar& tExit) {
+    if (delta == Scalar(0)) {
+        return movingMin + movingSize > targetMin && movingMin < targetMin + targetSize;
+    }
+    Scalar t0 = (targetMin - (movingMin + movingSize)) / delta;
+    Scalar t1 = (targetMin + targetSize - movingMin) / delta;
+    if (t0 > t1) std::swap(t0, t1);
+    tEnter = std::max(tEnter, t0);
+    tExit = std::min(tExit, t1);
+    return true;
+}
+} // namespace
+
+bool sweptAabb(const Rect& moving, Vec2 displacement, const Rect& target, Scalar& tEnter, Scalar& tExit) {
+    tEnter = 0;
+    tExit = 1;
+    if (!clipAxis(moving.left, moving.width, displacement.x, target.left, target.width, tEnter, tExit)) return false;
+    if (!clipAxis(moving.top, moving.height, displacement.y, target.top, target.height, tEnter, tExit)) return false;
+    return tEnter < tExit;
+}
+
+Scalar firstContact(const CollisionMask& aMask, const Rect& aEnd, Vec2 aStep,
+                    const CollisionMask& bMask, const Rect& bEnd, Vec2 bStep) {
+    const Vec2 aStart(aEnd.left - aStep.x, aEnd.top - aStep.y);
+    const Vec2 bStart(bEnd.left - bStep.x, bEnd.top - bStep.y);
+    const Vec2 relative = aStep - bStep;
+
+    Scalar tEnter, tExit;
+    if (!sweptAabb(Rect(aStart.x, aStart.y, aEnd.width, aEnd.height), relative,
+                   Rect(bStart.x, bStart.y, bEnd.width, bEnd.height), tEnter, tExit)) {
+        return -1;
+    }
+
+    // Próbkowanie masek w przedziale przenikania AABB, krok <= 1 px ruchu względnego
+    const Scalar distance = std::max(scalarAbs(relative.x), scalarAbs(relative.y)) * (tExit - tEnter);
+    const int steps = std::max(1, ceilToInt(distance));
+    for (int i = 0; i <= steps; ++i) {
+        const Scalar t = tEnter + (tExit - tEnter) * Scalar(i) / Scalar(steps);
+        if (masksOverlap(aMask, aStart + aStep * t, bMask, bStart + bStep * t)) return t;
+    }
+    return -1;
+}
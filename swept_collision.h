@@ -0,0 +1,15 @@
+﻿#pragma once
+#include <SFML/Graphics.hpp>
+#include "collision_mask.h"
+#include "fixed_point.h"
+
+// --- Ciągła detekcja kolizji (swept AABB) ---
+// Prostokąt `moving` przesuwa się o `displacement` względem nieruchomego `target`.
+// Zwraca przedział czasu [tEnter, tExit] ⊂ [0, 1], w którym prostokąty się przenikają.
+bool sweptAabb(const Rect& moving, Vec2 displacement, const Rect& target, Scalar& tEnter, Scalar& tExit);
+
+// Najwcześniejsza chwila t ∈ [0, 1] kroku, w której obiekty A i B (oba w ruchu) stykają się pełnymi pikselami masek,
+// albo -1, gdy w tym kroku nie ma trafienia. aEnd/bEnd to prostokąty na końcu kroku, aStep/bStep przesunięcia w kroku.
+// Po trafieniu AABB maski są sprawdzane co <= 1 px ruchu względnego, więc szybki pocisk nie przeskoczy celu.
+Scalar firstContact(const CollisionMask& aMask, const Rect& aEnd, Vec2 aStep,
+                    const CollisionMask& bMask, const Rect& bEnd, Vec2 bStep);
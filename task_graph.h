@@ -0,0 +1,85 @@
+﻿#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include "job_system.h"
+#include "trace.h"
+
+// --- Graf zadań z deklarowanymi danymi ---
+// Zadanie deklaruje, które zasoby (bity maski) czyta, a które zapisuje. Zadanie zależy od każdego
+// wcześniej dodanego zadania, z którym ma konflikt (zapis-odczyt, odczyt-zapis, zapis-zapis), więc
+// kolejność dodawania to kolejność kodu sekwencyjnego, a zadania bez wspólnych danych idą równolegle.
+// Bez puli (albo z jednym wątkiem) zadania wykonują się po prostu w kolejności dodania.
+// Graf buduje się raz; run() przyjmuje kontekst kroku, więc zadania to zwykłe wskaźniki do funkcji.
+template <typename Context>
+class TaskGraph {
+public:
+    using Resources = std::uint32_t;
+    using Function = void (*)(Context&);
+
+    void add(const char* name, Resources reads, Resources writes, Function function) {
+        Task task{name, reads, writes, function, 0, {}};
+        for (std::size_t i = 0; i < m_tasks.size(); ++i) {
+            Task& earlier = m_tasks[i];
+            if ((earlier.writes & (reads | writes)) || (earlier.reads & writes)) {
+                earlier.successors.push_back(m_tasks.size());
+                ++task.predecessors;
+            }
+        }
+        m_tasks.push_back(task);
+    }
+
+    void run(Context& context, JobSystem* jobs) const {
+        if (!jobs || jobs->threadCount() == 1) {
+            for (const Task& task : m_tasks) execute(task, context);
+            return;
+        }
+        std::unique_ptr<std::atomic<int>[]> waiting(new std::atomic<int>[m_tasks.size()]);
+        for (std::size_t i = 0; i < m_tasks.size(); ++i) waiting[i].store(m_tasks[i].predecessors, std::memory_order_relaxed);
+        JobSystem::Group group;
+        Launch launch{this, &context, jobs, &group, waiting.get()};
+        for (std::size_t i = 0; i < m_tasks.size(); ++i) {
+            if (m_tasks[i].predecessors == 0) launch.start(i);
+        }
+        jobs->wait(group);
+    }
+
+private:
+    struct Task {
+        const char* name; // Też nazwa zakresu na osi czasu (--trace)
+        Resources reads;
+        Resources writes;
+        Function function;
+        int predecessors;
+        std::vector<std::size_t> successors;
+    };
+
+    // Stan jednego run(): zakończone zadanie zleca następniki, na które czekało jako ostatnie
+    struct Launch {
+        const TaskGraph* graph;
+        Context* context;
+        JobSystem* jobs;
+        JobSystem::Group* group;
+        std::atomic<int>* waiting;
+
+        void start(std::size_t index) const {
+            const Launch self = *this;
+            jobs->run(*group, [self, index]() {
+                const Task& task = self.graph->m_tasks[index];
+                execute(task, *self.context);
+                for (std::size_t next : task.successors) {
+                    if (self.waiting[next].fetch_sub(1, std::memory_order_acq_rel) == 1) self.start(next);
+                }
+            });
+        }
+    };
+
+    static void execute(const Task& task, Context& context) {
+        TRACE_SCOPE(task.name);
+        task.function(context);
+    }
+
+    std::vector<Task> m_tasks;
+};
@@ -0,0 +1,119 @@
+﻿#include "texture_resample.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+#include "trace.h"
+
+namespace {
+// Wkład pikseli źródła w jeden piksel celu wzdłuż osi: first..first+count-1 z wagami od weightOffset
+struct Span {
+    unsigned int first;
+    unsigned int count;
+    std::size_t weightOffset;
+};
+
+struct AxisFilter {
+    std::vector<Span> spans;
+    std::vector<float> weights;
+};
+
+// Piksel celu i pokrywa źródło w [i * scale, (i + 1) * scale); wagi to długości przecięć, suma 1
+AxisFilter boxFilter(unsigned int sourceLength, unsigned int targetLength) {
+    AxisFilter filter;
+    filter.spans.resize(targetLength);
+    const double scale = static_cast<double>(sourceLength) / targetLength;
+    for (unsigned int i = 0; i < targetLength; ++i) {
+        const double begin = i * scale;
+        const double end = std::min((i + 1) * scale, static_cast<double>(sourceLength));
+        const unsigned int first = static_cast<unsigned int>(begin);
+        const unsigned int last = std::min(static_cast<unsigned int>(std::ceil(end)), sourceLength) - 1;
+        filter.spans[i] = Span{first, last - first + 1, filter.weights.size()};
+        for (unsigned int s = first; s <= last; ++s) {
+            const double covered = std::min(end, s + 1.0) - std::max(begin, static_cast<double>(s));
+            filter.weights.push_back(static_cast<float>(covered / (end - begin)));
+        }
+    }
+    return filter;
+}
+
+// --- Cztery kanały RGBA jako jedna wartość ---
+// Pętle po czterech kanałach kompilator zamienia na operacje wektorowe (jedna instrukcja na piksel)
+struct Pixel {
+    float c[4];
+};
+
+inline Pixel zeroPixel() { return Pixel{{0.f, 0.f, 0.f, 0.f}}; }
+inline Pixel addWeighted(Pixel sum, Pixel value, float weight) {
+    for (int i = 0; i < 4; ++i) sum.c[i] += value.c[i] * weight;
+    return sum;
+}
+
+inline Pixel premultiplied(const std::uint8_t* rgba) {
+    const float alpha = rgba[3] / 255.f;
+    return Pixel{{rgba[0] * alpha, rgba[1] * alpha, rgba[2] * alpha, static_cast<float>(rgba[3])}};
+}
+
+inline void storeUnpremultiplied(Pixel value, std::uint8_t* rgba) {
+    const float unscale = value.c[3] >= 0.5f ? 255.f / value.c[3] : 0.f;
+    for (int i = 0; i < 4; ++i) {
+        const float channel = i == 3 ? value.c[3] : value.c[i] * unscale;
+        rgba[i] = static_cast<std::uint8_t>(std::min(255.f, std::max(0.f, channel + 0.5f)));
+    }
+}
+} // namespace
+
+sf::Image downsampleImage(const sf::Image& source, sf::Vector2u size) {
+    const sf::Vector2u sourceSize = source.getSize();
+    size.x = std::max(1u, std::min(size.x, sourceSize.x));
+    size.y = std::max(1u, std::min(size.y, sourceSize.y));
+    if (sourceSize.x == 0 || sourceSize.y == 0 || size == sourceSize) return source;
+
+    const AxisFilter horizontal = boxFilter(sourceSize.x, size.x);
+    const AxisFilter vertical = boxFilter(sourceSize.y, size.y);
+    const std::uint8_t* pixels = source.getPixelsPtr();
+
+    // Przejście poziome: każdy wiersz źródła zwężony do size.x pikseli (premultiplikowanych)
+    std::vector<Pixel> row(sourceSize.x);
+    std::vector<Pixel> narrow(static_cast<std::size_t>(sourceSize.y) * size.x);
+    for (unsigned int y = 0; y < sourceSize.y; ++y) {
+        const std::uint8_t* sourceRow = pixels + static_cast<std::size_t>(y) * sourceSize.x * 4;
+        for (unsigned int x = 0; x < sourceSize.x; ++x) row[x] = premultiplied(sourceRow + x * 4);
+        Pixel* out = &narrow[static_cast<std::size_t>(y) * size.x];
+        for (unsigned int x = 0; x < size.x; ++x) {
+            const Span& span = horizontal.spans[x];
+            Pixel sum = zeroPixel();
+            for (unsigned int i = 0; i < span.count; ++i) sum = addWeighted(sum, row[span.first + i], horizontal.weights[span.weightOffset + i]);
+            out[x] = sum;
+        }
+    }
+
+    // Przejście pionowe: wiersz celu to ważona suma całych zwężonych wierszy
+    std::vector<std::uint8_t> target(static_cast<std::size_t>(size.x) * size.y * 4);
+    std::vector<Pixel> sum(size.x);
+    for (unsigned int y = 0; y < size.y; ++y) {
+        const Span& span = vertical.spans[y];
+        std::fill(sum.begin(), sum.end(), zeroPixel());
+        for (unsigned int i = 0; i < span.count; ++i) {
+            const Pixel* in = &narrow[static_cast<std::size_t>(span.first + i) * size.x];
+            const float weight = vertical.weights[span.weightOffset + i];
+            for (unsigned int x = 0; x < size.x; ++x) sum[x] = addWeighted(sum[x], in[x], weight);
+        }
+        std::uint8_t* out = &target[static_cast<std::size_t>(y) * size.x * 4];
+        for (unsigned int x = 0; x < size.x; ++x) storeUnpremultiplied(sum[x], out + x * 4);
+    }
+    sf::Image result;
+    result.create(size.x, size.y, target.data());
+    return result;
+}
+
+bool loadSpriteTexture(sf::Texture& texture, const sf::Image& image, sf::Vector2f screenSize, float supersample, bool mipmaps) {
+    TRACE_SCOPE("resample texture");
+    if (supersample <= 0.f) return texture.loadFromImage(image);
+    const sf::Vector2u size(static_cast<unsigned int>(std::ceil(screenSize.x * supersample)),
+                            static_cast<unsigned int>(std::ceil(screenSize.y * supersample)));
+    if (!texture.loadFromImage(downsampleImage(image, size))) return false;
+    texture.setSmooth(true);
+    if (mipmaps) texture.generateMipmap(); // Bez wsparcia sterownika zostaje samo wygładzanie
+    return true;
+}
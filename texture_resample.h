@@ -0,0 +1,15 @@
+﻿#pragma once
+#include <SFML/Graphics.hpp>
+
+// --- Tekstury w rozmiarze ekranowym ---
+// Obrazy źródłowe mają setki pikseli na bok, a sprite'y zajmują na ekranie kilkadziesiąt, więc GPU
+// dostaje obraz zmniejszony już przy ładowaniu: mniej pamięci tekstur i brak aliasingu przy rysowaniu.
+
+// Zmniejsza obraz do size filtrem pudełkowym: piksel celu to średnia ważona polem pokrycia pikseli
+// źródła, liczona w alfie premultiplikowanej (bez ciemnych obwódek wokół przezroczystych brzegów).
+// Filtr jest rozdzielny: najpierw wiersze, potem kolumny, każde przejście z gotową tabelą wag.
+sf::Image downsampleImage(const sf::Image& source, sf::Vector2u size);
+
+// Tekstura sprite'a rysowanego w rozmiarze screenSize: obraz zmniejszony do screenSize * supersample
+// (nigdy nie powiększa), wygładzana, z mipmapami przy mipmaps. supersample <= 0: oryginalny obraz jak dotąd.
+bool loadSpriteTexture(sf::Texture& texture, const sf::Image& image, sf::Vector2f screenSize, float supersample, bool mipmaps);
@@ -0,0 +1,157 @@
+﻿#include "timer_wheel.h"
+
+namespace {
+const TimerWheel::Tick SLOT_MASK = TimerWheel::SLOTS - 1;
+
+// Poziom timera: najwyższa grupa bitów, w której wygaśnięcie różni się od bieżącego ticku
+int levelFor(TimerWheel::Tick expiry, TimerWheel::Tick now) {
+    const TimerWheel::Tick diff = expiry ^ now;
+    int level = 0;
+    while (level < TimerWheel::LEVELS && (diff >> (TimerWheel::LEVEL_BITS * (level + 1))) != 0) ++level;
+    return level;
+}
+
+int lowestBit(std::uint64_t bits) {
+    int bit = 0;
+    while (!(bits & 1u)) {
+        bits >>= 1;
+        ++bit;
+    }
+    return bit;
+}
+} // namespace
+
+TimerWheel::Handle TimerWheel::schedule(Tick delay, std::uint32_t event) {
+    std::uint32_t index = m_free;
+    if (index != NONE) {
+        m_free = m_nodes[index].next;
+    } else {
+        index = static_cast<std::uint32_t>(m_nodes.size());
+        m_nodes.push_back(Node{0, 0, 0, NONE, NONE, NONE});
+    }
+    Node& node = m_nodes[index];
+    node.expiry = m_now + (delay > 0 ? delay : 1);
+    node.event = event;
+    insert(index);
+    ++m_active;
+    Handle handle;
+    handle.index = index;
+    handle.generation = node.generation;
+    return handle;
+}
+
+bool TimerWheel::pending(Handle handle) const {
+    return handle.index < m_nodes.size() && m_nodes[handle.index].generation == handle.generation &&
+           m_nodes[handle.index].list != NONE;
+}
+
+bool TimerWheel::cancel(Handle handle) {
+    if (!pending(handle)) return false;
+    unlink(handle.index);
+    release(handle.index);
+    return true;
+}
+
+TimerWheel::Tick TimerWheel::remaining(Handle handle) const {
+    return pending(handle) ? m_nodes[handle.index].expiry - m_now : 0;
+}
+
+void TimerWheel::advance(Tick target, std::vector<std::uint32_t>& fired) {
+    while (m_now < target) {
+        if (m_active == 0) { // Nic nie czeka: sam przeskok czasu
+            m_now = target;
+            return;
+        }
+        // Najbliższy tick, na którym coś się dzieje: niepusta przegródka poziomu 0 dalej w bieżącym
+        // bloku SLOTS ticków albo początek następnego bloku (kaskada z wyższych poziomów)
+        const int position = static_cast<int>(m_now & SLOT_MASK);
+        const std::uint64_t ahead = position == SLOTS - 1 ? 0 : (m_occupied[0] >> (position + 1)) << (position + 1);
+        const Tick next = ahead ? (m_now & ~SLOT_MASK) + lowestBit(ahead) : (m_now | SLOT_MASK) + 1;
+        if (next > target) {
+            m_now = target;
+            return;
+        }
+        m_now = next;
+
+        if ((m_now & SLOT_MASK) == 0) {
+            // Od góry, żeby timery schodziły przez kolejne poziomy w tym samym ticku
+            if ((m_now & ((Tick(1) << (LEVEL_BITS * LEVELS)) - 1)) == 0) cascade(OVERFLOW_LIST);
+            for (int level = LEVELS - 1; level >= 1; --level) {
+                if (m_now & ((Tick(1) << (LEVEL_BITS * level)) - 1)) continue;
+                cascade(static_cast<std::uint32_t>(level * SLOTS + ((m_now >> (LEVEL_BITS * level)) & SLOT_MASK)));
+            }
+        }
+
+        for (std::uint32_t index = detach(static_cast<std::uint32_t>(m_now & SLOT_MASK)); index != NONE;) {
+            const std::uint32_t next = m_nodes[index].next;
+            fired.push_back(m_nodes[index].event);
+            release(index);
+            index = next;
+        }
+    }
+}
+
+void TimerWheel::clear() {
+    for (std::uint32_t index = 0; index < m_nodes.size(); ++index) {
+        if (m_nodes[index].list != NONE) release(index);
+    }
+    m_lists.fill(List{});
+    m_occupied.fill(0);
+    m_now = 0;
+}
+
+void TimerWheel::insert(std::uint32_t index) {
+    const Tick expiry = m_nodes[index].expiry;
+    const int level = levelFor(expiry, m_now);
+    if (level >= LEVELS) {
+        link(OVERFLOW_LIST, index);
+        return;
+    }
+    link(static_cast<std::uint32_t>(level * SLOTS + ((expiry >> (LEVEL_BITS * level)) & SLOT_MASK)), index);
+}
+
+void TimerWheel::link(std::uint32_t list, std::uint32_t index) {
+    Node& node = m_nodes[index];
+    List& target = m_lists[list];
+    node.list = list;
+    node.prev = target.tail;
+    node.next = NONE;
+    if (target.tail != NONE) m_nodes[target.tail].next = index;
+    else target.head = index;
+    target.tail = index;
+    if (list != OVERFLOW_LIST) m_occupied[list / SLOTS] |= std::uint64_t(1) << (list % SLOTS);
+}
+
+void TimerWheel::unlink(std::uint32_t index) {
+    Node& node = m_nodes[index];
+    List& source = m_lists[node.list];
+    if (node.prev != NONE) m_nodes[node.prev].next = node.next;
+    else source.head = node.next;
+    if (node.next != NONE) m_nodes[node.next].prev = node.prev;
+    else source.tail = node.prev;
+    if (source.head == NONE && node.list != OVERFLOW_LIST) m_occupied[node.list / SLOTS] &= ~(std::uint64_t(1) << (node.list % SLOTS));
+}
+
+void TimerWheel::release(std::uint32_t index) {
+    Node& node = m_nodes[index];
+    node.list = NONE;
+    ++node.generation;
+    node.next = m_free;
+    m_free = index;
+    --m_active;
+}
+
+std::uint32_t TimerWheel::detach(std::uint32_t list) {
+    const std::uint32_t head = m_lists[list].head;
+    m_lists[list] = List{};
+    if (list != OVERFLOW_LIST) m_occupied[list / SLOTS] &= ~(std::uint64_t(1) << (list % SLOTS));
+    return head;
+}
+
+void TimerWheel::cascade(std::uint32_t list) {
+    for (std::uint32_t index = detach(list); index != NONE;) {
+        const std::uint32_t next = m_nodes[index].next;
+        insert(index);
+        index = next;
+    }
+}
@@ -0,0 +1,75 @@
+﻿#pragma once
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// --- Hierarchiczne koło timerów (czas symulacji) ---
+// Czas płynie w tickach (jednostkę wybiera użytkownik). Koło ma LEVELS poziomów po SLOTS przegródek:
+// poziom L trzyma timery, których tick wygaśnięcia różni się od bieżącego najwyżej na bitach grupy L
+// (6 bitów na poziom). Gdy czas dochodzi do przegródki wyższego poziomu, jej timery schodzą niżej,
+// aż na poziomie 0 wygasają. Dodanie i anulowanie to O(1) (lista dwukierunkowa w puli węzłów),
+// a czekające timery nic nie kosztują, dopóki czas nie dojdzie do ich przegródki.
+// Timery niosą tylko numer zdarzenia (bez wywołań zwrotnych ze wskaźnikami), więc koło można
+// kopiować razem ze stanem gry (rollback) i kopia odpala to samo.
+class TimerWheel {
+public:
+    using Tick = std::uint64_t;
+
+    static const std::uint32_t NONE = UINT32_MAX;
+    static const int LEVEL_BITS = 6;
+    static const int SLOTS = 1 << LEVEL_BITS;
+    static const int LEVELS = 4; // Zasięg 2^24 ticków; dalsze timery czekają na liście nadmiarowej
+
+    // Uchwyt do anulowania; po wygaśnięciu lub anulowaniu przestaje pasować (generacja węzła)
+    struct Handle {
+        std::uint32_t index = NONE;
+        std::uint32_t generation = 0;
+    };
+
+    Tick now() const { return m_now; }
+    std::size_t size() const { return m_active; }
+
+    // Zdarzenie event po delay tickach (delay 0: przy najbliższym advance)
+    Handle schedule(Tick delay, std::uint32_t event);
+    bool cancel(Handle handle); // false, gdy timer już wygasł albo był anulowany
+    bool pending(Handle handle) const;
+    Tick remaining(Handle handle) const; // Ticki do wygaśnięcia; 0 dla nieaktywnego uchwytu
+
+    // Przesuwa czas do target i dopisuje do fired zdarzenia wygasłych timerów, w kolejności wygaśnięcia
+    // (ten sam tick: kolejność dodania). Koszt zależy od liczby ticków i wygasłych timerów, nie od czekających.
+    void advance(Tick target, std::vector<std::uint32_t>& fired);
+
+    void clear(); // Bez timerów, czas od zera (pamięć węzłów zostaje)
+
+private:
+    static const std::uint32_t OVERFLOW_LIST = LEVELS * SLOTS; // Lista timerów poza zasięgiem poziomów
+
+    struct Node {
+        Tick expiry;
+        std::uint32_t event;
+        std::uint32_t generation;
+        std::uint32_t list; // Przegródka (level * SLOTS + slot), OVERFLOW_LIST albo NONE dla wolnego węzła
+        std::uint32_t prev;
+        std::uint32_t next; // Też lista wolnych węzłów
+    };
+
+    struct List {
+        std::uint32_t head = NONE;
+        std::uint32_t tail = NONE;
+    };
+
+    void insert(std::uint32_t index);
+    void link(std::uint32_t list, std::uint32_t index);
+    void unlink(std::uint32_t index);
+    void release(std::uint32_t index);
+    std::uint32_t detach(std::uint32_t list); // Zabiera całą listę, zwraca jej pierwszy węzeł
+    void cascade(std::uint32_t list); // Timery listy wstawione od nowa względem m_now
+
+    Tick m_now = 0;
+    std::size_t m_active = 0;
+    std::vector<Node> m_nodes;
+    std::uint32_t m_free = NONE;
+    std::array<List, LEVELS * SLOTS + 1> m_lists{};
+    std::array<std::uint64_t, LEVELS> m_occupied{}; // Bit na niepustą przegródkę poziomu
+};
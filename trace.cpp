@@ -0,0 +1,126 @@
+﻿#include "trace.h"
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace trace_detail {
+std::atomic<bool> enabled{false};
+} // namespace trace_detail
+
+namespace {
+const std::size_t CHUNK_EVENTS = 4096;
+const std::size_t MAX_EVENTS_PER_THREAD = std::size_t(1) << 22; // ~128 MB na wątek; dalsze zdarzenia są liczone jako utracone
+
+struct TraceEvent {
+    const char* name;
+    std::int64_t startNs; // Od początku sesji
+    std::int64_t durationNs;
+};
+
+// Bufor jednego wątku: kawałki stałej wielkości, więc dopisywanie nie przenosi starszych zdarzeń
+struct ThreadBuffer {
+    unsigned int tid;
+    const char* name = nullptr;
+    std::vector<std::unique_ptr<TraceEvent[]>> chunks;
+    std::size_t count = 0;
+    std::size_t dropped = 0;
+};
+
+std::mutex registryMutex;
+std::vector<std::unique_ptr<ThreadBuffer>> registry; // Bufory żyją do końca programu
+std::chrono::steady_clock::time_point sessionStart;
+thread_local ThreadBuffer* localBuffer = nullptr;
+
+ThreadBuffer& threadBuffer() {
+    if (!localBuffer) {
+        std::lock_guard<std::mutex> lock(registryMutex);
+        registry.emplace_back(new ThreadBuffer());
+        localBuffer = registry.back().get();
+        localBuffer->tid = static_cast<unsigned int>(registry.size());
+    }
+    return *localBuffer;
+}
+
+// Nazwy to literały z kodu, ale cudzysłów i backslash i tak są zamieniane
+void writeJsonString(std::ostream& out, const char* text) {
+    out << '"';
+    for (const char* c = text; *c; ++c) {
+        if (*c == '"' || *c == '\\') out << '\\';
+        out << *c;
+    }
+    out << '"';
+}
+
+bool writeTraceFile(const std::string& path) {
+    std::ofstream out(path, std::ios::trunc);
+    if (!out) return false;
+    char number[32];
+    std::lock_guard<std::mutex> lock(registryMutex);
+    out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+    bool first = true;
+    std::size_t dropped = 0;
+    for (const auto& buffer : registry) {
+        dropped += buffer->dropped;
+        if (buffer->name) {
+            out << (first ? "" : ",\n") << "{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":1,\"tid\":" << buffer->tid << ",\"args\":{\"name\":";
+            writeJsonString(out, buffer->name);
+            out << "}}";
+            first = false;
+        }
+        for (std::size_t i = 0; i < buffer->count; ++i) {
+            const TraceEvent& event = buffer->chunks[i / CHUNK_EVENTS][i % CHUNK_EVENTS];
+            out << (first ? "" : ",\n") << "{\"ph\":\"X\",\"pid\":1,\"tid\":" << buffer->tid << ",\"name\":";
+            writeJsonString(out, event.name);
+            // Mikrosekundy z częścią ułamkową (format wymaga us)
+            std::snprintf(number, sizeof(number), "%.3f", event.startNs / 1000.0);
+            out << ",\"ts\":" << number;
+            std::snprintf(number, sizeof(number), "%.3f", event.durationNs / 1000.0);
+            out << ",\"dur\":" << number << "}";
+            first = false;
+        }
+    }
+    out << "\n]}\n";
+    if (dropped > 0) std::cerr << "Trace: " << dropped << " events dropped (per-thread buffer full)\n";
+    return static_cast<bool>(out);
+}
+} // namespace
+
+namespace trace_detail {
+void record(const char* name, std::chrono::steady_clock::time_point start, std::chrono::steady_clock::time_point end) {
+    ThreadBuffer& buffer = threadBuffer();
+    if (buffer.count >= MAX_EVENTS_PER_THREAD) {
+        ++buffer.dropped;
+        return;
+    }
+    if (buffer.count % CHUNK_EVENTS == 0 && buffer.count / CHUNK_EVENTS == buffer.chunks.size()) {
+        buffer.chunks.emplace_back(new TraceEvent[CHUNK_EVENTS]);
+    }
+    buffer.chunks[buffer.count / CHUNK_EVENTS][buffer.count % CHUNK_EVENTS] = TraceEvent{
+        name,
+        std::chrono::duration_cast<std::chrono::nanoseconds>(start - sessionStart).count(),
+        std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count()};
+    ++buffer.count;
+}
+} // namespace trace_detail
+
+void setTraceThreadName(const char* name) {
+    if (tracingEnabled()) threadBuffer().name = name;
+}
+
+TraceSession::TraceSession(const std::string& path) : m_path(path) {
+    if (m_path.empty()) return;
+    sessionStart = std::chrono::steady_clock::now();
+    trace_detail::enabled.store(true);
+    setTraceThreadName("main");
+}
+
+TraceSession::~TraceSession() {
+    if (m_path.empty()) return;
+    trace_detail::enabled.store(false);
+    if (writeTraceFile(m_path)) std::cout << "Trace written to " << m_path << "\n";
+    else std::cerr << "Trace: could not write " << m_path << "\n";
+}
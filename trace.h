@@ -0,0 +1,54 @@
+﻿#pragma once
+#include <atomic>
+#include <chrono>
+#include <string>
+
+// --- Oś czasu faz klatki (--trace plik) ---
+// TRACE_SCOPE("nazwa") zapisuje zdarzenie z czasem początku i długością zakresu do bufora wątku.
+// Bufor ma jednego pisarza (swój wątek), więc zapis nie bierze blokady; mutex jest tylko przy
+// pierwszym zdarzeniu wątku (rejestracja bufora). Przy wyjściu zdarzenia wszystkich wątków trafiają
+// do pliku JSON w formacie Chrome trace (chrome://tracing, ui.perfetto.dev).
+// Bez --trace zakres kosztuje jeden odczyt flagi. Nazwy muszą żyć do końca programu (literały).
+
+namespace trace_detail {
+extern std::atomic<bool> enabled;
+void record(const char* name, std::chrono::steady_clock::time_point start, std::chrono::steady_clock::time_point end);
+} // namespace trace_detail
+
+inline bool tracingEnabled() { return trace_detail::enabled.load(std::memory_order_relaxed); }
+
+// Nazwa wątku na osi czasu (tylko przy włączonym śledzeniu)
+void setTraceThreadName(const char* name);
+
+class TraceScope {
+public:
+    explicit TraceScope(const char* name) : m_name(tracingEnabled() ? name : nullptr) {
+        if (m_name) m_start = std::chrono::steady_clock::now();
+    }
+    ~TraceScope() {
+        if (m_name) trace_detail::record(m_name, m_start, std::chrono::steady_clock::now());
+    }
+    TraceScope(const TraceScope&) = delete;
+    TraceScope& operator=(const TraceScope&) = delete;
+
+private:
+    const char* m_name;
+    std::chrono::steady_clock::time_point m_start;
+};
+
+#define TRACE_CONCAT_INNER(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_INNER(a, b)
+#define TRACE_SCOPE(name) TraceScope TRACE_CONCAT(traceScope, __LINE__)(name)
+
+// Śledzenie od utworzenia do zniszczenia; destruktor zapisuje plik (wątki robocze muszą być już
+// zatrzymane albo bezczynne). Pusta ścieżka: nic nie robi.
+class TraceSession {
+public:
+    explicit TraceSession(const std::string& path);
+    ~TraceSession();
+    TraceSession(const TraceSession&) = delete;
+    TraceSession& operator=(const TraceSession&) = delete;
+
+private:
+    std::string m_path;
+};
@@ -0,0 +1,295 @@
+﻿#include "versus.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include "trace.h"
+
+namespace {
+const double FRAME_BUDGET_MS = 1000.0 / 60.0;
+const std::uint64_t INPUT_STREAM = 0x1F;  // Strumień PCG losowych wejść pomiaru
+
+// Najniższy żywy wróg w kolumnie formacji; false, gdy kolumna jest pusta
+bool lowestInColumn(const Formation& formation, int column, Rect& shooter) {
+    for (int row = formation.rows - 1; row >= 0; --row) {
+        const int cell = row * formation.columns + column;
+        if (formation.isAlive(cell)) {
+            shooter = formation.cellBounds(cell);
+            return true;
+        }
+    }
+    return false;
+}
+
+// --- FNV-1a ---
+void hashBytes(std::uint64_t& hash, const void* data, std::size_t size) {
+    const unsigned char* bytes = static_cast<const unsigned char*>(data);
+    for (std::size_t i = 0; i < size; ++i) {
+        hash ^= bytes[i];
+        hash *= 0x100000001B3ull;
+    }
+}
+
+template <typename T>
+void hashValue(std::uint64_t& hash, const T& value) {
+    hashBytes(hash, &value, sizeof(value));
+}
+
+void writeFrame(std::uint8_t* out, std::uint32_t frame) {
+    for (int i = 0; i < 4; ++i) out[i] = static_cast<std::uint8_t>(frame >> (8 * i));
+}
+
+std::uint32_t readFrame(const std::uint8_t* in) {
+    std::uint32_t frame = 0;
+    for (int i = 0; i < 4; ++i) frame |= static_cast<std::uint32_t>(in[i]) << (8 * i);
+    return frame;
+}
+} // namespace
+
+void resetVersus(VersusGame& versus, const GameAssets& assets) {
+    resetGame(versus.game, assets);
+    versus.shipSinceShot = PLAYER_SHOOT_INTERVAL;
+    versus.formationSinceShot = 0.f;
+    versus.aimColumn = FORMATION_COLUMNS / 2;
+}
+
+void stepVersus(VersusGame& versus, const GameAssets& assets, std::uint8_t shipInput, std::uint8_t formationInput) {
+    Game& game = versus.game;
+    if (game.state != GameState::Playing && ((shipInput | formationInput) & VersusRestart)) resetVersus(versus, assets);
+
+    if (game.state == GameState::Playing) {
+        // Statek
+        float move = 0.f;
+        if (shipInput & VersusLeft) move -= 1.f;
+        if (shipInput & VersusRight) move += 1.f;
+        movePlayer(game, move * PLAYER_SPEED * VERSUS_STEP);
+        versus.shipSinceShot += VERSUS_STEP;
+        if ((shipInput & VersusFire) && versus.shipSinceShot >= PLAYER_SHOOT_INTERVAL) {
+            fireBullet(game, assets, 0.f);
+            versus.shipSinceShot = 0.f;
+        }
+
+        // Formacja: celownik o kolumnę na wciśnięcie, strzał z najniższego wroga kolumny
+        const std::uint8_t pressed = formationInput & ~versus.previousFormationInput;
+        if (pressed & VersusLeft) versus.aimColumn = std::max(0, versus.aimColumn - 1);
+        if (pressed & VersusRight) versus.aimColumn = std::min(FORMATION_COLUMNS - 1, versus.aimColumn + 1);
+        versus.formationSinceShot += VERSUS_STEP;
+        Rect shooter;
+        if ((formationInput & VersusFire) && versus.formationSinceShot >= FORMATION_SHOOT_INTERVAL &&
+            lowestInColumn(game.formation, versus.aimColumn, shooter)) {
+            fireEnemyBullet(game, assets, shooter);
+            versus.formationSinceShot = 0.f;
+        }
+    }
+    versus.previousFormationInput = formationInput;
+
+    stepGame(game, assets, VERSUS_STEP);
+}
+
+std::uint64_t versusChecksum(VersusGame& versus) {
+    Game& game = versus.game;
+    std::uint64_t hash = 0xCBF29CE484222325ull;
+    hashValue(hash, game.state);
+    hashValue(hash, game.score);
+    hashValue(hash, game.steps);
+    hashValue(hash, game.enemyDirection);
+    hashValue(hash, game.formation.origin.x);
+    hashValue(hash, game.formation.origin.y);
+    hashBytes(hash, game.formation.alive.data(), game.formation.alive.size() * sizeof(std::uint64_t));
+    hashValue(hash, versus.shipSinceShot);
+    hashValue(hash, versus.formationSinceShot);
+    hashValue(hash, versus.aimColumn);
+    game.world.each<Transform>([&](Entity, Transform& transform) {
+        hashValue(hash, transform.position.x);
+        hashValue(hash, transform.position.y);
+    });
+    return hash;
+}
+
+// --- Transport ---
+
+std::pair<LoopbackTransport, LoopbackTransport> LoopbackTransport::createPair(std::size_t delayPackets) {
+    auto toSecond = std::make_shared<Queue>();
+    auto toFirst = std::make_shared<Queue>();
+    return std::make_pair(LoopbackTransport(toSecond, toFirst, delayPackets), LoopbackTransport(toFirst, toSecond, delayPackets));
+}
+
+void LoopbackTransport::send(const InputPacket& packet) {
+    m_outbox->push_back(packet);
+}
+
+bool LoopbackTransport::receive(InputPacket& packet) {
+    if (m_inbox->size() <= m_delay) return false;
+    packet = m_inbox->front();
+    m_inbox->pop_front();
+    return true;
+}
+
+UdpTransport::UdpTransport(unsigned short localPort, const sf::IpAddress& peer, unsigned short peerPort)
+    : m_peer(peer), m_peerPort(peerPort) {
+    m_bound = m_socket.bind(localPort) == sf::Socket::Done;
+    m_socket.setBlocking(false);
+}
+
+void UdpTransport::send(const InputPacket& packet) {
+    std::uint8_t wire[InputPacket::WIRE_SIZE];
+    writeFrame(wire, packet.frame);
+    std::memcpy(wire + 4, packet.inputs, InputPacket::HISTORY);
+    m_socket.send(wire, sizeof(wire), m_peer, m_peerPort); // Zgubiony datagram pokryje historia w następnych
+}
+
+bool UdpTransport::receive(InputPacket& packet) {
+    std::uint8_t wire[InputPacket::WIRE_SIZE];
+    std::size_t received = 0;
+    sf::IpAddress sender;
+    unsigned short senderPort = 0;
+    while (m_socket.receive(wire, sizeof(wire), received, sender, senderPort) == sf::Socket::Done) {
+        if (received != InputPacket::WIRE_SIZE || sender != m_peer) continue;
+        packet.frame = readFrame(wire);
+        std::memcpy(packet.inputs, wire + 4, InputPacket::HISTORY);
+        return true;
+    }
+    return false;
+}
+
+// --- Sesja rollback ---
+
+RollbackSession::RollbackSession(const VersusGame& start, const GameAssets& assets, VersusSide localSide, Transport& transport)
+    : m_versus(start), m_assets(assets), m_localSide(localSide), m_transport(transport), m_records(RING, FrameRecord(start)), m_rollbackFrom(0) {}
+
+std::uint8_t RollbackSession::remoteInputFor(std::uint32_t frame) const {
+    if (frame < m_remoteFrames) return m_remoteInputs[frame % RING];
+    return m_remoteFrames > 0 ? m_remoteInputs[(m_remoteFrames - 1) % RING] : 0; // Predykcja: jak ostatnio
+}
+
+void RollbackSession::receiveRemote() {
+    InputPacket packet;
+    while (m_transport.receive(packet)) {
+        // Nowe klatki po kolei; starsze niż historia pakietu muszą przyjść w innym pakiecie
+        while (m_remoteFrames <= packet.frame && packet.frame - m_remoteFrames < InputPacket::HISTORY) {
+            const std::uint32_t frame = m_remoteFrames++;
+            const std::uint8_t input = packet.inputs[packet.frame - frame];
+            m_remoteInputs[frame % RING] = input;
+            if (frame < m_frame && record(frame).remoteInput != input) m_rollbackFrom = std::min(m_rollbackFrom, frame);
+        }
+    }
+}
+
+void RollbackSession::sendLocal() {
+    if (m_frame == 0) return;
+    InputPacket packet;
+    packet.frame = m_frame - 1;
+    for (std::uint32_t i = 0; i < static_cast<std::uint32_t>(InputPacket::HISTORY) && i <= packet.frame; ++i) {
+        packet.inputs[i] = record(packet.frame - i).localInput;
+    }
+    m_transport.send(packet);
+}
+
+void RollbackSession::simulate(std::uint32_t frame) {
+    FrameRecord& slot = record(frame);
+    slot.state = m_versus;
+    slot.remoteInput = remoteInputFor(frame);
+    if (m_localSide == VersusSide::Ship) stepVersus(m_versus, m_assets, slot.localInput, slot.remoteInput);
+    else stepVersus(m_versus, m_assets, slot.remoteInput, slot.localInput);
+}
+
+bool RollbackSession::advance(std::uint8_t localInput) {
+    m_rollbackFrom = m_frame;
+    receiveRemote();
+
+    // Cofnięcie do najstarszej błędnej predykcji i ponowne przeliczenie do bieżącej klatki
+    if (m_rollbackFrom < m_frame) {
+        TRACE_SCOPE("rollback");
+        const int depth = static_cast<int>(m_frame - m_rollbackFrom);
+        m_versus = record(m_rollbackFrom).state;
+        for (std::uint32_t frame = m_rollbackFrom; frame < m_frame; ++frame) simulate(frame);
+        ++m_rollbacks;
+        m_resimulatedFrames += static_cast<std::uint64_t>(depth);
+        m_maxRollbackDepth = std::max(m_maxRollbackDepth, depth);
+    }
+
+    if (m_frame >= m_remoteFrames + MAX_ROLLBACK) {
+        ++m_stalls;
+        sendLocal(); // Powtórka na wypadek zgubionych pakietów
+        return false;
+    }
+
+    record(m_frame).localInput = localInput;
+    simulate(m_frame);
+    ++m_frame;
+    sendLocal();
+    return true;
+}
+
+bool RollbackSession::checksumAt(std::uint32_t frame, std::uint64_t& checksum) {
+    if (frame >= m_frame || frame > m_remoteFrames || m_frame - frame >= RING) return false;
+    checksum = versusChecksum(record(frame).state);
+    return true;
+}
+
+int runRollbackBenchmark(const LaunchOptions& options) {
+    if (options.maxFrames == 0) { // Bez klatek nie ma czasów do percentyli
+        std::cout << "Rollback: no frames to measure (--frames 0)\n";
+        return 0;
+    }
+    GameImages images;
+    if (!loadGameImages(images)) {
+        std::cerr << "Rollback: could not load game images\n";
+        return EXIT_FAILURE;
+    }
+    const GameAssets assets = buildGameAssets(images);
+
+    VersusGame start(options.seed);
+    resetVersus(start, assets);
+    auto link = LoopbackTransport::createPair(RollbackSession::MAX_ROLLBACK - 1);
+    RollbackSession ship(start, assets, VersusSide::Ship, link.first);
+    RollbackSession formation(start, assets, VersusSide::Formation, link.second);
+
+    // Wejścia zmieniają się co klatkę, więc predykcja "jak ostatnio" prawie zawsze się myli
+    Pcg32 inputRng(options.seed, INPUT_STREAM);
+    std::vector<double> frameMs;
+    frameMs.reserve(options.maxFrames * 2);
+    unsigned long checks = 0;
+    unsigned long desyncs = 0;
+
+    for (unsigned long i = 0; i < options.maxFrames; ++i) {
+        for (RollbackSession* session : {&ship, &formation}) {
+            const std::uint8_t input = static_cast<std::uint8_t>(inputRng.below(VersusRestart * 2)); // Dowolne bity VersusButton
+            const auto frameStart = std::chrono::steady_clock::now();
+            session->advance(input);
+            frameMs.push_back(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - frameStart).count());
+        }
+
+        const std::uint32_t common = std::min(ship.confirmedFrame(), formation.confirmedFrame());
+        std::uint64_t shipChecksum = 0;
+        std::uint64_t formationChecksum = 0;
+        if (ship.checksumAt(common, shipChecksum) && formation.checksumAt(common, formationChecksum)) {
+            ++checks;
+            if (shipChecksum != formationChecksum) ++desyncs;
+        }
+    }
+
+    std::sort(frameMs.begin(), frameMs.end());
+    double total = 0.0;
+    for (double ms : frameMs) total += ms;
+    const double p99 = frameMs[frameMs.size() * 99 / 100];
+    std::uint64_t rollbacks = 0;
+    std::uint64_t resimulated = 0;
+    int maxDepth = 0;
+    for (const RollbackSession* side : {&ship, &formation}) {
+        rollbacks += side->rollbacks();
+        resimulated += side->resimulatedFrames();
+        maxDepth = std::max(maxDepth, side->maxRollbackDepth());
+    }
+
+    std::cout << std::fixed << std::setprecision(3)
+              << "Rollback: " << frameMs.size() << " session frames, " << rollbacks << " rollbacks, "
+              << resimulated << " resimulated frames (max depth " << maxDepth << ")\n"
+              << "  frame time: mean " << total / frameMs.size() << " ms, p99 " << p99 << " ms, max "
+              << frameMs.back() << " ms (budget " << FRAME_BUDGET_MS << " ms)\n"
+              << "  determinism: " << desyncs << " desyncs in " << checks << " checksum comparisons\n";
+    return desyncs == 0 && p99 < FRAME_BUDGET_MS ? 0 : EXIT_FAILURE;
+}
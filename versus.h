@@ -0,0 +1,163 @@
+﻿#pragma once
+#include <SFML/Network.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <utility>
+#include <vector>
+#include "game.h"
+#include "options.h"
+
+// --- Tryb versus: gracz 1 steruje statkiem, gracz 2 formacją ---
+// Gracz formacji przesuwa celownik po kolumnach i strzela najniższym żywym wrogiem wskazanej kolumny.
+// Krok ma stałą długość i zależy tylko od stanu i dwóch bajtów wejścia, więc obie strony liczą to samo.
+const float VERSUS_STEP = 1.0f / 60.0f;
+const float FORMATION_SHOOT_INTERVAL = 0.6f;
+
+enum class VersusSide { Ship, Formation };
+
+// Bity wejścia jednej strony na jedną klatkę (dla formacji Left/Right przesuwają celownik)
+enum VersusButton : std::uint8_t {
+    VersusLeft = 1,
+    VersusRight = 2,
+    VersusFire = 4,
+    VersusRestart = 8 // Po końcu rundy; działa z wejścia dowolnej strony
+};
+
+// Cały stan potrzebny do kroku; kopia przez wartość to pełny, dokładny punkt powrotu dla rollbacku
+struct VersusGame {
+    explicit VersusGame(std::uint32_t seed) : game(seed) { game.versus = true; }
+
+    Game game;
+    float shipSinceShot = PLAYER_SHOOT_INTERVAL;
+    float formationSinceShot = 0.f;
+    int aimColumn = FORMATION_COLUMNS / 2;
+    std::uint8_t previousFormationInput = 0; // Celownik reaguje na zbocza, nie na przytrzymanie
+};
+
+void resetVersus(VersusGame& versus, const GameAssets& assets);
+
+// Jeden krok VERSUS_STEP bez efektów ubocznych poza stanem versus
+void stepVersus(VersusGame& versus, const GameAssets& assets, std::uint8_t shipInput, std::uint8_t formationInput);
+
+// FNV-1a po stanie rozgrywki i pozycjach wszystkich encji (wykrywanie rozjazdu stron)
+std::uint64_t versusChecksum(VersusGame& versus);
+
+// --- Transport wejść ---
+// Pakiet niesie ostatnie HISTORY wejść nadawcy, więc zgubiony datagram uzupełniają następne
+struct InputPacket {
+    static const int HISTORY = 16;
+    static const std::size_t WIRE_SIZE = 4 + HISTORY; // Numer klatki (u32 LE) + wejścia
+
+    std::uint32_t frame = 0;        // Klatka najnowszego wejścia
+    std::uint8_t inputs[HISTORY]{}; // inputs[i]: wejście klatki frame - i
+};
+
+class Transport {
+public:
+    virtual ~Transport() = default;
+    virtual void send(const InputPacket& packet) = 0;
+    virtual bool receive(InputPacket& packet) = 0; // false: nic nie czeka
+};
+
+// Dwie końcówki w jednym procesie. Pakiet jest do odebrania, gdy za nim wysłano już delayPackets
+// kolejnych, więc przy jednym wysłaniu na klatkę opóźnienie wynosi delayPackets klatek.
+class LoopbackTransport : public Transport {
+public:
+    static std::pair<LoopbackTransport, LoopbackTransport> createPair(std::size_t delayPackets);
+
+    void send(const InputPacket& packet) override;
+    bool receive(InputPacket& packet) override;
+
+private:
+    using Queue = std::deque<InputPacket>;
+    LoopbackTransport(std::shared_ptr<Queue> outbox, std::shared_ptr<Queue> inbox, std::size_t delayPackets)
+        : m_outbox(std::move(outbox)), m_inbox(std::move(inbox)), m_delay(delayPackets) {}
+
+    std::shared_ptr<Queue> m_outbox;
+    std::shared_ptr<Queue> m_inbox;
+    std::size_t m_delay;
+};
+
+// Datagramy UDP (np. dwa procesy na localhost); nieblokujące, obce nadawce są ignorowane
+class UdpTransport : public Transport {
+public:
+    UdpTransport(unsigned short localPort, const sf::IpAddress& peer, unsigned short peerPort);
+
+    bool bound() const { return m_bound; }
+    void send(const InputPacket& packet) override;
+    bool receive(InputPacket& packet) override;
+
+private:
+    sf::UdpSocket m_socket;
+    sf::IpAddress m_peer;
+    unsigned short m_peerPort;
+    bool m_bound;
+};
+
+// --- Sesja z predykcją i cofaniem (rollback) ---
+// Lokalna klatka jest liczona od razu, a brakujące wejście drugiej strony przewidywane jako powtórzenie
+// ostatniego znanego. Gdy przyjdzie prawdziwe i różni się od przewidywanego, stan wraca do najstarszej
+// błędnej klatki i kolejne klatki są liczone ponownie w tej samej klatce renderowania.
+class RollbackSession {
+public:
+    static const int MAX_ROLLBACK = 8; // Dalej lokalna strona nie wybiega, tylko czeka na drugą
+
+    RollbackSession(const VersusGame& start, const GameAssets& assets, VersusSide localSide, Transport& transport);
+
+    // Jedna klatka z wejściem lokalnego gracza; false: klatka wstrzymana (za duża przewaga nad drugą stroną)
+    bool advance(std::uint8_t localInput);
+
+    VersusGame& state() { return m_versus; } // Do rysowania (World nie ma stałego each)
+    std::uint32_t frame() const { return m_frame; }
+
+    // Pierwsza klatka, przed którą znane są już wszystkie wejścia obu stron
+    std::uint32_t confirmedFrame() const { return m_frame < m_remoteFrames ? m_frame : m_remoteFrames; }
+
+    // Suma kontrolna potwierdzonego stanu z początku klatki frame; false, gdy nie ma go już w buforze
+    bool checksumAt(std::uint32_t frame, std::uint64_t& checksum);
+
+    // --- Statystyki ---
+    std::uint64_t rollbacks() const { return m_rollbacks; }
+    std::uint64_t resimulatedFrames() const { return m_resimulatedFrames; }
+    int maxRollbackDepth() const { return m_maxRollbackDepth; }
+    std::uint64_t stalls() const { return m_stalls; }
+
+private:
+    // Pierścień >= 2 * MAX_ROLLBACK: druga strona może też wybiegać do MAX_ROLLBACK klatek naprzód
+    static const std::uint32_t RING = 32;
+
+    struct FrameRecord {
+        explicit FrameRecord(const VersusGame& state) : state(state) {}
+        VersusGame state;           // Stan na początku klatki
+        std::uint8_t localInput = 0;
+        std::uint8_t remoteInput = 0; // Użyte w kroku (przewidziane albo potwierdzone)
+    };
+
+    FrameRecord& record(std::uint32_t frame) { return m_records[frame % RING]; }
+    void receiveRemote();
+    void sendLocal();
+    std::uint8_t remoteInputFor(std::uint32_t frame) const;
+    void simulate(std::uint32_t frame);
+
+    VersusGame m_versus;
+    const GameAssets& m_assets;
+    VersusSide m_localSide;
+    Transport& m_transport;
+
+    std::vector<FrameRecord> m_records;
+    std::uint8_t m_remoteInputs[RING]{};
+    std::uint32_t m_frame = 0;        // Liczba zasymulowanych klatek
+    std::uint32_t m_remoteFrames = 0; // Znane wejścia drugiej strony: klatki [0, m_remoteFrames)
+    std::uint32_t m_rollbackFrom;     // Najstarsza klatka z błędną predykcją (m_frame: brak)
+
+    std::uint64_t m_rollbacks = 0;
+    std::uint64_t m_resimulatedFrames = 0;
+    int m_maxRollbackDepth = 0;
+    std::uint64_t m_stalls = 0;
+};
+
+// Pomiar: dwie sesje na pętli z opóźnieniem MAX_ROLLBACK klatek i losowymi wejściami, więc prawie każda
+// klatka cofa się o MAX_ROLLBACK; przy okazji porównuje sumy kontrolne potwierdzonych stanów obu stron.
+int runRollbackBenchmark(const LaunchOptions& options);